@@ -0,0 +1,187 @@
+/**
+ * @file KernelBenchmark.cpp
+ * @brief Times the back-projections specialized for fixed sizes against the generic one of the
+ * same kernel variant.
+ *
+ * Usage: ct_ray_sim_bench [kernels] [repetitions]
+ */
+
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <numbers>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Kernels.hpp"
+
+using std::size_t;
+using std::vector;
+
+namespace {
+
+constexpr size_t NUM_ANGLES = 8;
+
+// A benchmark run, returning the image it computed
+using Benchmark = std::function<vector<double>()>;
+
+/**
+ * @brief The fastest time in milliseconds and the image computed by the runs of one kernel.
+ */
+struct Timing {
+    double milliseconds;
+    vector<double> image;
+};
+
+/**
+ * @brief Runs the generic and the specialized benchmark alternately, so that frequency changes and
+ * other load affect both alike, and returns the fastest run of each.
+ */
+std::pair<Timing, Timing> compare(
+    const size_t repetitions,
+    const Benchmark& generic,
+    const Benchmark& fixed
+) {
+    auto timings = std::pair<Timing, Timing>();
+
+    const auto measure = [](const Benchmark& run, Timing& timing, bool first) {
+        const auto start = std::chrono::steady_clock::now();
+        timing.image = run();
+        const auto elapsed = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start
+        );
+
+        if (first || elapsed.count() < timing.milliseconds) timing.milliseconds = elapsed.count();
+    };
+
+    for (size_t i = 0; i < repetitions; ++i) {
+        measure(generic, timings.first, i == 0);
+        measure(fixed, timings.second, i == 0);
+    }
+
+    return timings;
+}
+
+/**
+ * @brief Back-projects one projection for each of NUM_ANGLES angles into a size x size image.
+ */
+vector<double> backProjectImage(
+    const Kernels::BackProjectRowFunction backProjectRow,
+    const vector<double>& projection,
+    const size_t size
+) {
+    auto image = vector<double>(size * size, 0.0);
+    auto coverage = vector<double>(size * size, 0.0);
+    const auto* projectionData = projection.data();
+
+    for (size_t angle = 0; angle < NUM_ANGLES; ++angle) {
+        const auto phi = std::numbers::pi * static_cast<double>(angle) / NUM_ANGLES;
+
+        for (size_t row = 0; row < size; ++row) {
+            auto* imageRow = image.data() + row * size;
+            backProjectRow(
+                &projectionData,
+                &imageRow,
+                1,
+                coverage.data() + row * size,
+                static_cast<std::int32_t>(size),
+                size,
+                0.5,
+                1.0,
+                static_cast<double>(row) + 0.5,
+                std::sin(phi),
+                std::cos(phi)
+            );
+        }
+    }
+
+    return image;
+}
+
+/**
+ * @brief Prints the timings of one size and returns false if the specialized back-projection
+ * computed a different image than the generic one.
+ */
+bool report(const size_t size, const std::pair<Timing, Timing>& timings) {
+    const auto& [generic, fixed] = timings;
+    fmt::print(
+        "{:>6} {:>12.3f} {:>12.3f} {:>8.2f}x\n",
+        size,
+        generic.milliseconds,
+        fixed.milliseconds,
+        generic.milliseconds / fixed.milliseconds
+    );
+
+    // Compare every pixel, a checksum could hide differences that cancel out
+    auto numDiffering = size_t(0);
+    auto maxDifference = 0.0;
+    for (size_t i = 0; i < generic.image.size(); ++i) {
+        if (generic.image[i] != fixed.image[i]) {
+            ++numDiffering;
+            maxDifference = std::max(maxDifference, std::abs(generic.image[i] - fixed.image[i]));
+        }
+    }
+
+    if (numDiffering > 0 || generic.image.size() != fixed.image.size()) {
+        spdlog::error(
+            "The back-projection for size {} differs from the generic one in {} pixels (by up to "
+            "{}).",
+            size,
+            numDiffering,
+            maxDifference
+        );
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const auto isa = argc > 1 ? std::string(argv[1]) : std::string("auto");
+    const auto repetitions = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5ul;
+
+    if (!Kernels::select(isa) || repetitions == 0) {
+        spdlog::error("Usage: {} [kernels] [repetitions]", argv[0]);
+        std::exit(EXIT_FAILURE);
+    }
+
+    const auto& kernels = Kernels::active();
+    if (kernels.fixed()->size == 0) {
+        spdlog::error("No specialized sizes are compiled in, see CT_RAY_SIM_KERNEL_SIZES.");
+        std::exit(EXIT_FAILURE);
+    }
+
+    auto generator = std::mt19937(42);
+    auto distribution = std::uniform_real_distribution<double>(0.0, 1.0);
+    auto identical = true;
+
+    fmt::print("{:>6} {:>12} {:>12} {:>9}\n", "size", "generic ms", "fixed ms", "speedup");
+
+    for (const auto* entry = kernels.fixed(); entry->size != 0; ++entry) {
+        const auto size = entry->size;
+
+        auto projection = vector<double>(size);
+        for (auto& value : projection) value = distribution(generator);
+
+        identical &= report(
+            size,
+            compare(
+                repetitions,
+                [&] { return backProjectImage(kernels.backProjectRow, projection, size); },
+                [&] { return backProjectImage(entry->backProjectRow, projection, size); }
+            )
+        );
+    }
+
+    return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
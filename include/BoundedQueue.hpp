@@ -0,0 +1,120 @@
+#pragma once
+/**
+ * @file BoundedQueue.hpp
+ * @brief This file contains the declaration and implementation of the BoundedQueue class.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/**
+ * @class BoundedQueue
+ * @brief A blocking, thread-safe FIFO queue with a fixed capacity. Used to hand work between the
+ * stages of a pipeline while limiting the number of in-flight items.
+ *
+ * @tparam T The type of the queued items.
+ */
+template <typename T>
+class BoundedQueue {
+  public:
+    /**
+     * @brief Constructs a BoundedQueue object with the provided capacity.
+     *
+     * @param capacity The maximum number of items held by the queue. A capacity of 0 is treated
+     * as 1.
+     */
+    explicit BoundedQueue(std::size_t capacity) : m_capacity(capacity > 0 ? capacity : 1) { }
+
+    // The queue owns synchronization primitives and is neither copyable nor movable
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Pushes an item onto the queue. Blocks while the queue is full.
+     *
+     * @param item The item to push.
+     * @return true if the item was queued, false if the queue has been closed.
+     */
+    bool push(T&& item) {
+        auto lock = std::unique_lock(m_mutex);
+        m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+
+        if (m_closed) return false;
+
+        m_items.push_back(std::move(item));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pushes an item if the queue has room, without blocking.
+     *
+     * @param item The item to push. It is left untouched if it was not queued.
+     * @return true if the item was queued, false if the queue is full or has been closed.
+     */
+    bool tryPush(T&& item) {
+        auto lock = std::unique_lock(m_mutex);
+        if (m_closed || m_items.size() >= m_capacity) return false;
+
+        m_items.push_back(std::move(item));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pops an item from the queue. Blocks while the queue is empty and not closed.
+     *
+     * @return The next item, or std::nullopt if the queue has been closed and fully drained.
+     */
+    std::optional<T> pop() {
+        auto lock = std::unique_lock(m_mutex);
+        m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+
+        if (m_items.empty()) return std::nullopt;
+
+        auto item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return item;
+    }
+
+    /**
+     * @brief Pops an item if one is available, without blocking.
+     *
+     * @return The next item, or std::nullopt if the queue is currently empty.
+     */
+    std::optional<T> tryPop() {
+        auto lock = std::unique_lock(m_mutex);
+        if (m_items.empty()) return std::nullopt;
+
+        auto item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.notify_one();
+        return item;
+    }
+
+    /**
+     * @brief Closes the queue. Pending items can still be popped, but further pushes fail and
+     * blocked producers and consumers are woken up.
+     */
+    void close() {
+        {
+            auto lock = std::lock_guard(m_mutex);
+            m_closed = true;
+        }
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+  private:
+    std::size_t m_capacity;
+    std::deque<T> m_items;
+    bool m_closed = false;
+
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+};
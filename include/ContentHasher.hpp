@@ -0,0 +1,81 @@
+#pragma once
+/**
+ * @file ContentHasher.hpp
+ * @brief This file contains the declaration of the ContentHasher class.
+ */
+
+#include <array>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <type_traits>
+
+/**
+ * @class ContentHasher
+ * @brief Computes a 128-bit, non-cryptographic hash over a sequence of values and matrices, used
+ * to address cached results by their inputs.
+ */
+class ContentHasher {
+  public:
+    /**
+     * @brief Constructs a ContentHasher object with an empty state.
+     */
+    ContentHasher();
+
+    // Default copy constructor and copy assignment operator
+    ContentHasher(const ContentHasher&) = default;
+    ContentHasher& operator=(const ContentHasher&) = default;
+
+    // Default move constructor and move assignment operator
+    ContentHasher(ContentHasher&&) noexcept = default;
+    ContentHasher& operator=(ContentHasher&&) noexcept = default;
+
+    /**
+     * @brief Adds raw bytes to the hash.
+     *
+     * @param data The bytes to add.
+     * @param size The number of bytes.
+     * @return A reference to the ContentHasher object.
+     */
+    ContentHasher& update(const void* data, std::size_t size);
+
+    /**
+     * @brief Adds a string to the hash. The length is hashed as well, so that consecutive strings
+     * cannot run into each other.
+     *
+     * @param value The string to add.
+     * @return A reference to the ContentHasher object.
+     */
+    ContentHasher& update(const std::string& value);
+
+    /**
+     * @brief Adds the size, type and data of a matrix to the hash.
+     *
+     * @param mat The matrix to add. Need not be continuous.
+     * @return A reference to the ContentHasher object.
+     */
+    ContentHasher& update(const cv::Mat& mat);
+
+    /**
+     * @brief Adds a trivially copyable value to the hash.
+     *
+     * @param value The value to add.
+     * @return A reference to the ContentHasher object.
+     */
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    ContentHasher& update(const T& value) {
+        return update(&value, sizeof(T));
+    }
+
+    /**
+     * @brief Returns the hash of everything added so far as 32 hexadecimal digits.
+     *
+     * @return The hexadecimal digest.
+     */
+    std::string hexDigest() const;
+
+  private:
+    std::array<std::uint64_t, 2> m_state;
+    std::uint64_t m_length;
+};
@@ -32,6 +32,14 @@ class DensityMap {
      */
     DensityMap(std::string&& imagePath);
 
+    /**
+     * @brief Constructs a DensityMap object from an image that is already in memory, e.g. one
+     * received through shared memory.
+     *
+     * @param image The square 8-bit grayscale image containing the density map.
+     */
+    explicit DensityMap(const cv::Mat& image);
+
     // Default copy constructor and copy assignment operator
     DensityMap(const DensityMap&) = default;
     DensityMap& operator=(const DensityMap&) = default;
@@ -57,6 +65,13 @@ class DensityMap {
      */
     std::size_t getSize() const noexcept;
 
+    /**
+     * @brief Returns the density values as a matrix.
+     *
+     * @return The density map (imageSize x imageSize, CV_64F).
+     */
+    const cv::Mat& getData() const noexcept;
+
     /**
      * @brief Loads the density map from the provided image file.
      *
@@ -64,6 +79,13 @@ class DensityMap {
      */
     void loadFromFilepath(const std::string& imagePath);
 
+    /**
+     * @brief Loads the density map from an 8-bit grayscale image in memory.
+     *
+     * @param image The square image containing the density map.
+     */
+    void loadFromImage(const cv::Mat& image);
+
   private:
     cv::Mat m_densityMap;
     std::size_t m_imageSize;
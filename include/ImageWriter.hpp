@@ -0,0 +1,106 @@
+#pragma once
+/**
+ * @file ImageWriter.hpp
+ * @brief This file contains the declaration of the ImageWriter class.
+ */
+
+#include <future>
+#include <opencv2/opencv.hpp>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BoundedQueue.hpp"
+
+/**
+ * @enum OutputFormat
+ * @brief The file formats images can be written in.
+ */
+enum class OutputFormat {
+    Png8,     ///< 8-bit grayscale PNG, normalized to [0, 255].
+    Png16,    ///< 16-bit grayscale PNG, normalized to [0, 65535].
+    Tiff32F,  ///< Lossless 32-bit floating-point TIFF, normalized to [0, 1].
+    Raw32F,   ///< Lossless 32-bit floating-point MatIO file, not normalized.
+};
+
+/**
+ * @class ImageWriter
+ * @brief Normalizes, encodes and writes images on a pool of background threads, so that encoding
+ * overlaps with computation.
+ *
+ * Every image is written to a temporary file and renamed into place, so readers never see a
+ * partially written file. The destructor waits for all pending writes.
+ */
+class ImageWriter {
+  public:
+    /**
+     * @brief Constructs an ImageWriter object and starts its threads.
+     *
+     * @param numThreads The number of writer threads. A value of 0 is treated as 1.
+     */
+    explicit ImageWriter(std::size_t numThreads);
+
+    // The writer owns threads and is neither copyable nor movable
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+
+    /**
+     * @brief Waits for all pending writes and stops the threads.
+     */
+    ~ImageWriter();
+
+    /**
+     * @brief Waits for all pending writes and stops the threads. No images can be queued
+     * afterwards. Called by the destructor if not called before.
+     */
+    void join();
+
+    /**
+     * @brief Queues an image for writing. Blocks while too many writes are pending. Throws
+     * std::logic_error if the writer has already been joined.
+     *
+     * The image data is shared, not copied, so it must not be modified until the write finished.
+     *
+     * @param image The image to write.
+     * @param outputPath The path to write to, without extension.
+     * @param format The format to write the image in.
+     * @return A future that becomes ready once the image has been written. Its get rethrows the
+     * std::runtime_error of a failed write.
+     */
+    std::future<void> write(
+        const cv::Mat& image, const std::string& outputPath, const OutputFormat format
+    );
+
+    /**
+     * @brief Returns the file name suffix (including the extension) used for a format.
+     *
+     * @param format The output format.
+     * @return The file name suffix.
+     */
+    static std::string suffixFor(const OutputFormat format);
+
+    /**
+     * @brief Returns the format with the given name (png8, png16, tiff or raw).
+     *
+     * @param name The name of the format.
+     * @return The format, or std::nullopt if the name is unknown.
+     */
+    static std::optional<OutputFormat> formatFromName(const std::string& name);
+
+  private:
+    /**
+     * @brief Normalizes, encodes and writes an image. Runs on a writer thread. Throws
+     * std::runtime_error if the image cannot be written.
+     *
+     * @param image The image to write.
+     * @param outputPath The path to write to, including the extension.
+     * @param format The format to write the image in.
+     */
+    static void writeNow(
+        const cv::Mat& image, const std::string& outputPath, const OutputFormat format
+    );
+
+    BoundedQueue<std::packaged_task<void()>> m_queue;
+    std::vector<std::thread> m_threads;
+};
@@ -0,0 +1,182 @@
+#pragma once
+/**
+ * @file Kernels.hpp
+ * @brief This file contains the declaration of the Kernels class and of the hot inner loops it
+ * dispatches to.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Declares the kernels of one instruction set in the namespace kernels::isa.
+ *
+ * src/Kernels.cpp defines them and is compiled once per instruction set, with CT_KERNEL_ISA set to
+ * the name of the namespace and the matching architecture flags.
+ */
+#define CT_DECLARE_KERNELS(isa)                                                                   \
+    namespace kernels::isa {                                                                      \
+    double traceRay(                                                                              \
+        const double* density,                                                                    \
+        std::size_t stride,                                                                       \
+        std::size_t size,                                                                         \
+        double originX,                                                                           \
+        double originY,                                                                           \
+        double directionX,                                                                        \
+        double directionY,                                                                        \
+        double tStart,                                                                            \
+        double tEnd,                                                                              \
+        double deltaT                                                                             \
+    );                                                                                            \
+    void backProjectRow(                                                                          \
+        const double* const* projections,                                                         \
+        double* const* imageRows,                                                                 \
+        std::size_t batchSize,                                                                    \
+        double* coverageRow,                                                                      \
+        std::int32_t detectorSize,                                                                \
+        std::size_t width,                                                                        \
+        double xStart,                                                                            \
+        double xStep,                                                                             \
+        double y,                                                                                 \
+        double sinAngle,                                                                          \
+        double cosAngle                                                                           \
+    );                                                                                            \
+    const Kernels::Fixed* fixedKernels();                                                         \
+    }
+
+/**
+ * @class Kernels
+ * @brief A table of the hot inner loops compiled for one instruction set.
+ *
+ * The loops are compiled for a portable baseline and, when the build enables
+ * CT_RAY_SIM_KERNEL_VARIANTS, additionally for SSE4.2, AVX2 and AVX-512. The best variant
+ * supported by the running CPU is selected on first use, so a single binary runs on every node
+ * and still uses the widest vector units available. All variants are compiled without
+ * floating-point contraction and produce identical results.
+ *
+ * Every variant additionally holds back-projections specialized for the sizes listed in the
+ * CT_RAY_SIM_KERNEL_SIZES build option (by default 256, 512, 1024 and 2048), with the detector
+ * size and row width known at compile time. backProjectRowFor returns them for matching sizes and
+ * the generic loop otherwise, with identical results.
+ */
+class Kernels {
+  public:
+    /**
+     * @brief Integrates the density along a ray with a fixed step size.
+     *
+     * @param density The row-major density data.
+     * @param stride The distance between two rows of the density data in elements.
+     * @param size The width and height of the density data.
+     * @param originX The x coordinate of the ray origin.
+     * @param originY The y coordinate of the ray origin.
+     * @param directionX The x component of the normalized ray direction.
+     * @param directionY The y component of the normalized ray direction.
+     * @param tStart The ray parameter of the first sample.
+     * @param tEnd The ray parameter at which the integration stops.
+     * @param deltaT The step size.
+     * @return The total density along the ray.
+     */
+    using TraceRayFunction = double (*)(
+        const double* density,
+        std::size_t stride,
+        std::size_t size,
+        double originX,
+        double originY,
+        double directionX,
+        double directionY,
+        double tStart,
+        double tEnd,
+        double deltaT
+    );
+
+    /**
+     * @brief Back-projects a batch of projections of the same angle into one image row, using
+     * linear interpolation between detector cells.
+     *
+     * Pixel positions are given in density map coordinates, so the row can belong to a region of
+     * interest or to a grid of a different resolution.
+     *
+     * @param projections The contiguous projections of the batch, detectorSize values each.
+     * @param imageRows The row of the image of every batch item.
+     * @param batchSize The number of projections and image rows.
+     * @param coverageRow The row of the coverage, counting the projections hitting each pixel,
+     * or nullptr to skip counting.
+     * @param detectorSize The number of detector cells (the size of the density map).
+     * @param width The number of pixels in the row.
+     * @param xStart The x coordinate of the first pixel center.
+     * @param xStep The distance between two pixel centers.
+     * @param y The y coordinate of the pixel centers of the row.
+     * @param sinAngle The sine of the projection angle.
+     * @param cosAngle The cosine of the projection angle.
+     */
+    using BackProjectRowFunction = void (*)(
+        const double* const* projections,
+        double* const* imageRows,
+        std::size_t batchSize,
+        double* coverageRow,
+        std::int32_t detectorSize,
+        std::size_t width,
+        double xStart,
+        double xStep,
+        double y,
+        double sinAngle,
+        double cosAngle
+    );
+
+    /**
+     * @brief The back-projection specialized for one size.
+     */
+    struct Fixed {
+        std::size_t size;
+        BackProjectRowFunction backProjectRow;
+    };
+
+    const char* isa;
+    TraceRayFunction traceRay;
+    BackProjectRowFunction backProjectRow;
+    const Fixed* (*fixed)();  ///< Returns the specialized kernels, ending with an entry of size 0.
+
+    /**
+     * @brief Returns the back-projection for rows of the given width, the specialized one if there
+     * is one for the detector size and the rows span the whole detector width.
+     *
+     * @param detectorSize The number of detector cells.
+     * @param width The number of pixels per row.
+     * @return The back-projection.
+     */
+    BackProjectRowFunction backProjectRowFor(
+        const std::int32_t detectorSize,
+        const std::size_t width
+    ) const noexcept;
+
+    /**
+     * @brief Returns the active kernels. Selects the best supported variant on first use.
+     *
+     * @return The active kernels.
+     */
+    static const Kernels& active();
+
+    /**
+     * @brief Selects the kernels of an instruction set. Should be called before any kernel runs.
+     *
+     * @param isa The name of the instruction set, or "auto" for the best supported one.
+     * @return true if the variant was selected, false if it is unknown, not compiled in or not
+     * supported by the running CPU.
+     */
+    static bool select(const std::string& isa);
+
+    /**
+     * @brief Returns the names of all variants that are compiled in and supported by the running
+     * CPU, from the most to the least capable.
+     *
+     * @return The names of the supported variants.
+     */
+    static std::vector<std::string> supported();
+};
+
+CT_DECLARE_KERNELS(baseline)
+CT_DECLARE_KERNELS(sse42)
+CT_DECLARE_KERNELS(avx2)
+CT_DECLARE_KERNELS(avx512)
@@ -0,0 +1,64 @@
+#pragma once
+/**
+ * @file MappedFile.hpp
+ * @brief This file contains the declaration of the MappedFile class.
+ */
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Maps a whole file read-only into memory.
+ *
+ * Pages are loaded by the operating system on first access and can be dropped again under memory
+ * pressure, so files larger than the available memory can be read as if they were one array.
+ */
+class MappedFile {
+  public:
+    /**
+     * @brief Maps the file at the provided path. Throws std::runtime_error on failure.
+     *
+     * @param path The path of the file to map.
+     */
+    explicit MappedFile(const std::string& path);
+
+    // The mapping is owned and is not copyable
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Custom move constructor and move assignment operator, the moved-from file is unmapped
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~MappedFile();
+
+    /**
+     * @brief Returns the mapped contents of the file.
+     *
+     * @return A pointer to the first byte, or nullptr for an empty file.
+     */
+    const unsigned char* data() const noexcept;
+
+    /**
+     * @brief Returns the size of the file.
+     *
+     * @return The size in bytes.
+     */
+    std::size_t size() const noexcept;
+
+  private:
+    /**
+     * @brief Unmaps the file and resets the object to the empty state.
+     */
+    void unmap() noexcept;
+
+    const unsigned char* m_data;
+    std::size_t m_size;
+#ifdef _WIN32
+    void* m_mapping;
+#endif
+};
@@ -0,0 +1,100 @@
+#pragma once
+/**
+ * @file MatIO.hpp
+ * @brief This file contains the declaration of the MatIO class.
+ */
+
+#include <cstdint>
+#include <istream>
+#include <opencv2/opencv.hpp>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+/**
+ * @class MatIO
+ * @brief Reads and writes matrices and plain values in a compact, lossless binary format.
+ *
+ * Values are written in native byte order, so files are meant to be exchanged between hosts of
+ * the same architecture. Read errors are reported as std::runtime_error.
+ */
+class MatIO {
+  public:
+    /**
+     * @brief Writes a trivially copyable value to the stream.
+     *
+     * @param stream The stream to write to.
+     * @param value The value to write.
+     */
+    template <typename T>
+    static void writeValue(std::ostream& stream, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "MatIO can only write plain values.");
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * @brief Reads a trivially copyable value from the stream.
+     *
+     * @param stream The stream to read from.
+     * @return The value read.
+     */
+    template <typename T>
+    static T readValue(std::istream& stream) {
+        static_assert(std::is_trivially_copyable_v<T>, "MatIO can only read plain values.");
+        auto value = T();
+        if (!stream.read(reinterpret_cast<char*>(&value), sizeof(T)))
+            throw std::runtime_error("Unexpected end of file.");
+        return value;
+    }
+
+    /**
+     * @brief Writes a magic string identifying a file format, followed by its version.
+     *
+     * @param stream The stream to write to.
+     * @param magic The magic string.
+     * @param version The version of the file format.
+     */
+    static void writeHeader(std::ostream& stream, const std::string& magic, uint32_t version);
+
+    /**
+     * @brief Reads and checks a header written by writeHeader.
+     *
+     * @param stream The stream to read from.
+     * @param magic The expected magic string.
+     * @param version The expected version of the file format.
+     */
+    static void readHeader(std::istream& stream, const std::string& magic, uint32_t version);
+
+    /**
+     * @brief Writes a string (its length and characters) to the stream.
+     *
+     * @param stream The stream to write to.
+     * @param value The string to write.
+     */
+    static void writeString(std::ostream& stream, const std::string& value);
+
+    /**
+     * @brief Reads a string written by writeString from the stream.
+     *
+     * @param stream The stream to read from.
+     * @return The string read.
+     */
+    static std::string readString(std::istream& stream);
+
+    /**
+     * @brief Writes a single-channel matrix (its size, type and data) to the stream.
+     *
+     * @param stream The stream to write to.
+     * @param mat The matrix to write. Need not be continuous.
+     */
+    static void writeMat(std::ostream& stream, const cv::Mat& mat);
+
+    /**
+     * @brief Reads a matrix written by writeMat from the stream.
+     *
+     * @param stream The stream to read from.
+     * @return The matrix read.
+     */
+    static cv::Mat readMat(std::istream& stream);
+};
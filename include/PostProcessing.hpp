@@ -45,6 +45,19 @@ class PostProcessing {
      */
     PostProcessing& normalize();
 
+    /**
+     * @brief Normalizes the image to the full range of the target depth and converts it. One
+     * sweep finds the minimum and maximum, a second one scales and converts directly into the
+     * target depth, without the intermediate floating-point image of normalize followed by to8U.
+     *
+     * Integer depths are scaled to [0, 255] (CV_8U) or [0, 65535] (CV_16U), floating-point depths
+     * to [0, 1].
+     *
+     * @param depth The target depth (CV_8U, CV_16U, CV_32F or CV_64F).
+     * @return A reference to the PostProcessing object.
+     */
+    PostProcessing& normalizeTo(int depth);
+
     /**
      * @brief Converts the image to 8-bit unsigned integer.
      *
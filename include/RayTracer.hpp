@@ -61,6 +61,29 @@ class RayTracer {
      */
     double traceRay(const Ray& ray) const;
 
+    /**
+     * @brief Traces the specified ray through the density map and returns the total density per
+     * material. Every sample is assigned to the first material whose upper density bound is not
+     * below the sampled density (the last material if none is).
+     *
+     * @param ray The ray to trace.
+     * @param materialBounds The upper density bound of each material in ascending order.
+     * @return The total density along the ray for each material.
+     */
+    std::vector<double> traceRayPerMaterial(
+        const Ray& ray, const std::vector<double>& materialBounds
+    ) const;
+
   private:
+    /**
+     * @brief Intersects the specified ray with the boundaries of the density map.
+     *
+     * @param ray The ray to intersect.
+     * @param tStart Set to the ray parameter at which the ray enters the density map.
+     * @param tEnd Set to the ray parameter at which the ray leaves the density map.
+     * @return true if the ray hits the density map, false otherwise.
+     */
+    bool intersectScanField(const Ray& ray, double& tStart, double& tEnd) const;
+
     const DensityMap& m_densityMap;
 };
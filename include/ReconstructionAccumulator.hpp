@@ -0,0 +1,171 @@
+#pragma once
+/**
+ * @file ReconstructionAccumulator.hpp
+ * @brief This file contains the declaration of the ReconstructionAccumulator class.
+ */
+
+#include <istream>
+#include <opencv2/opencv.hpp>
+#include <ostream>
+#include <vector>
+
+#include "ReconstructionGrid.hpp"
+
+/**
+ * @brief Whether an accumulator can normalize its projections after the fact.
+ */
+enum class Normalization {
+    Deferred,  ///< Track the coverage and the value range for getNormalizedImage.
+    None,      ///< Only sum the projections, e.g. ones that are normalized already.
+};
+
+/**
+ * @class ReconstructionAccumulator
+ * @brief Back-projects projections one angle at a time into a running reconstruction.
+ *
+ * Besides the back-projected sum, the accumulator tracks how many projections contributed to each
+ * pixel and the value range of all projections seen so far. This allows the min-max normalization
+ * of the sinogram (see Simulation::filterProjections) to be applied after the fact, so projections
+ * can be accumulated as soon as they are traced instead of waiting for the whole sinogram.
+ *
+ * An accumulator can hold a batch of reconstructions that share the same geometry, e.g. several
+ * noise realizations of one scan. The detector interpolation is then computed once per pixel and
+ * angle for the whole batch.
+ *
+ * The reconstruction is computed on a ReconstructionGrid, which may cover only a region of the
+ * image or use a different resolution. The cost of every projection is proportional to the
+ * number of grid pixels.
+ *
+ * Tracking the coverage costs an extra update per pixel and angle. An accumulator constructed
+ * with Normalization::None skips it, and then only provides the raw sum (getImage).
+ */
+class ReconstructionAccumulator {
+  public:
+    /**
+     * @brief Constructs an empty ReconstructionAccumulator for a batch of square images.
+     *
+     * @param imageSize The size of the reconstructed image (and the number of detector cells).
+     * @param batchSize The number of reconstructions accumulated side by side.
+     */
+    ReconstructionAccumulator(std::size_t imageSize, std::size_t batchSize = 1);
+
+    /**
+     * @brief Constructs an empty ReconstructionAccumulator for a batch of images on a grid.
+     *
+     * @param grid The grid the images are reconstructed on.
+     * @param detectorSize The number of detector cells (the size of the density map).
+     * @param batchSize The number of reconstructions accumulated side by side.
+     * @param normalization Whether to track what getNormalizedImage needs.
+     */
+    ReconstructionAccumulator(
+        const ReconstructionGrid& grid,
+        std::size_t detectorSize,
+        std::size_t batchSize = 1,
+        Normalization normalization = Normalization::Deferred
+    );
+
+    // Default copy constructor and copy assignment operator
+    ReconstructionAccumulator(const ReconstructionAccumulator&) = default;
+    ReconstructionAccumulator& operator=(const ReconstructionAccumulator&) = default;
+
+    // Default move constructor and move assignment operator
+    ReconstructionAccumulator(ReconstructionAccumulator&&) noexcept = default;
+    ReconstructionAccumulator& operator=(ReconstructionAccumulator&&) noexcept = default;
+
+    /**
+     * @brief Back-projects a single projection into the reconstruction.
+     *
+     * @param projection The projection as a column vector (detectorSize x 1). Projections of
+     * other depths than CV_64F are converted.
+     * @param phi The angle of the projection in radians.
+     */
+    void accumulate(const cv::Mat& projection, const double phi);
+
+    /**
+     * @brief Back-projects one projection per batch item, all taken at the same angle.
+     *
+     * @param projections The projections as column vectors (detectorSize x 1), one per batch
+     * item. Projections of other depths than CV_64F are converted.
+     * @param phi The angle of the projections in radians.
+     */
+    void accumulate(const std::vector<cv::Mat>& projections, const double phi);
+
+    /**
+     * @brief Returns the back-projected sum of all accumulated projections as they were given.
+     *
+     * @param item The index of the batch item.
+     * @return The raw reconstruction.
+     */
+    const cv::Mat& getImage(std::size_t item = 0) const noexcept;
+
+    /**
+     * @brief Returns the reconstruction as if every projection had been min-max normalized over
+     * the whole sinogram before back-projection. Throws std::logic_error for an accumulator
+     * constructed with Normalization::None.
+     *
+     * The normalization is applied to the accumulated sums, so the result equals that of
+     * normalizing first up to floating-point rounding, but is not bit-identical to it.
+     *
+     * @param item The index of the batch item.
+     * @return The normalized reconstruction.
+     */
+    cv::Mat getNormalizedImage(std::size_t item = 0) const;
+
+    /**
+     * @brief Returns the number of projections accumulated so far.
+     *
+     * @return The number of accumulated projections.
+     */
+    std::size_t getNumProjections() const noexcept;
+
+    /**
+     * @brief Returns the grid the images are reconstructed on.
+     *
+     * @return The reconstruction grid.
+     */
+    const ReconstructionGrid& getGrid() const noexcept;
+
+    /**
+     * @brief Adds the projections accumulated by another accumulator of the same grid, e.g. one
+     * that processed a different range of angles of the same scan. Both must have been
+     * constructed with the same Normalization.
+     *
+     * @param other The accumulator to merge into this one.
+     */
+    void merge(const ReconstructionAccumulator& other);
+
+    /**
+     * @brief Returns a deep copy of the accumulator. Copies made by the copy constructor share
+     * the image data, like copies of a cv::Mat.
+     *
+     * @return The copy.
+     */
+    ReconstructionAccumulator clone() const;
+
+    /**
+     * @brief Writes the state of the accumulator to the stream. Throws std::logic_error for an
+     * accumulator constructed with Normalization::None.
+     *
+     * @param stream The stream to write to.
+     * @see MatIO
+     */
+    void write(std::ostream& stream) const;
+
+    /**
+     * @brief Reads an accumulator written by write from the stream.
+     *
+     * @param stream The stream to read from.
+     * @return The accumulator read.
+     */
+    static ReconstructionAccumulator read(std::istream& stream);
+
+  private:
+    std::size_t m_imageSize;
+    ReconstructionGrid m_grid;
+    Normalization m_normalization;
+    std::vector<cv::Mat> m_images;
+    cv::Mat m_coverage;
+    std::vector<double> m_min;
+    std::vector<double> m_max;
+    std::size_t m_numProjections;
+};
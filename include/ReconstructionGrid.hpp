@@ -0,0 +1,141 @@
+#pragma once
+/**
+ * @file ReconstructionGrid.hpp
+ * @brief This file contains the declaration of the ReconstructionGrid class.
+ */
+
+#include <cstddef>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class ReconstructionGrid
+ * @brief The pixel grid a reconstruction is computed on, in pixel coordinates of the density map.
+ *
+ * A grid covers a rectangle of the density map with square pixels of arbitrary size, so it can
+ * describe a region of interest, a lower or higher output resolution, or both. The cost of a
+ * reconstruction is proportional to the number of grid pixels. The full grid at native resolution
+ * reproduces the reconstruction of the whole image exactly.
+ */
+class ReconstructionGrid {
+  public:
+    /**
+     * @brief Constructs a ReconstructionGrid object.
+     *
+     * @param x The x coordinate of the left edge of the grid in density map pixels.
+     * @param y The y coordinate of the top edge of the grid in density map pixels.
+     * @param width The number of grid pixels per row.
+     * @param height The number of grid rows.
+     * @param pixelSize The size of a grid pixel in density map pixels.
+     */
+    ReconstructionGrid(
+        const double x,
+        const double y,
+        const std::size_t width,
+        const std::size_t height,
+        const double pixelSize
+    );
+
+    // Default copy constructor and copy assignment operator
+    ReconstructionGrid(const ReconstructionGrid&) = default;
+    ReconstructionGrid& operator=(const ReconstructionGrid&) = default;
+
+    // Default move constructor and move assignment operator
+    ReconstructionGrid(ReconstructionGrid&&) noexcept = default;
+    ReconstructionGrid& operator=(ReconstructionGrid&&) noexcept = default;
+
+    bool operator==(const ReconstructionGrid&) const = default;
+
+    /**
+     * @brief Returns the grid covering the whole density map at native resolution.
+     *
+     * @param imageSize The size of the density map.
+     * @return The full grid.
+     */
+    static ReconstructionGrid full(const std::size_t imageSize);
+
+    /**
+     * @brief Returns the grid covering a region of the density map at a scaled resolution.
+     *
+     * @param roi The region in density map pixels.
+     * @param outputScale The number of grid pixels per density map pixel, e.g. 0.5 for half
+     * resolution. Every dimension keeps at least one pixel.
+     * @return The grid of the region.
+     */
+    static ReconstructionGrid region(const cv::Rect& roi, const double outputScale);
+
+    /**
+     * @brief Returns a grid over the same area with pixels factor times as large, rounding the
+     * number of pixels up.
+     *
+     * @param factor The factor by which the pixel size grows.
+     * @return The coarsened grid.
+     */
+    ReconstructionGrid coarsened(const std::size_t factor) const;
+
+    /**
+     * @brief Returns the part of the grid covered by a rectangle of grid pixels, e.g. one tile.
+     * The pixels of the subgrid are at exactly the same positions as in this grid.
+     *
+     * @param pixels The rectangle in grid pixels.
+     * @return The subgrid.
+     */
+    ReconstructionGrid subgrid(const cv::Rect& pixels) const;
+
+    /**
+     * @brief Returns the density map x coordinate of the center of a grid column.
+     *
+     * @param column The index of the column.
+     * @return The x coordinate of the pixel center.
+     */
+    double columnCenter(const std::size_t column) const noexcept;
+
+    /**
+     * @brief Returns the density map y coordinate of the center of a grid row.
+     *
+     * @param row The index of the row.
+     * @return The y coordinate of the pixel center.
+     */
+    double rowCenter(const std::size_t row) const noexcept;
+
+    /**
+     * @brief Returns the x coordinate of the left edge of the grid in density map pixels.
+     *
+     * @return The x coordinate.
+     */
+    double getX() const noexcept;
+
+    /**
+     * @brief Returns the y coordinate of the top edge of the grid in density map pixels.
+     *
+     * @return The y coordinate.
+     */
+    double getY() const noexcept;
+
+    /**
+     * @brief Returns the number of grid pixels per row.
+     *
+     * @return The width of the grid.
+     */
+    std::size_t getWidth() const noexcept;
+
+    /**
+     * @brief Returns the number of grid rows.
+     *
+     * @return The height of the grid.
+     */
+    std::size_t getHeight() const noexcept;
+
+    /**
+     * @brief Returns the size of a grid pixel in density map pixels.
+     *
+     * @return The pixel size.
+     */
+    double getPixelSize() const noexcept;
+
+  private:
+    double m_x;
+    double m_y;
+    std::size_t m_width;
+    std::size_t m_height;
+    double m_pixelSize;
+};
@@ -0,0 +1,74 @@
+#pragma once
+/**
+ * @file ResultCache.hpp
+ * @brief This file contains the declaration of the ResultCache class.
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "SimulationResult.hpp"
+
+/**
+ * @class ResultCache
+ * @brief An on-disk cache of simulation results, addressed by a hash of all simulation inputs.
+ *
+ * Every entry is a single file written to a temporary name and atomically renamed into place, so
+ * several processes can share one cache directory and never read a partially written entry. Hits
+ * refresh the modification time of an entry, and the least recently used entries are evicted
+ * once the cache exceeds its size limit.
+ */
+class ResultCache {
+  public:
+    /**
+     * @brief Constructs a ResultCache object in the provided directory, creating it if needed.
+     *
+     * @param cacheDir The directory holding the cache entries.
+     * @param maxBytes The maximum total size of all entries in bytes.
+     */
+    ResultCache(const std::string& cacheDir, std::uintmax_t maxBytes);
+
+    // Default copy constructor and copy assignment operator
+    ResultCache(const ResultCache&) = default;
+    ResultCache& operator=(const ResultCache&) = default;
+
+    // Default move constructor and move assignment operator
+    ResultCache(ResultCache&&) noexcept = default;
+    ResultCache& operator=(ResultCache&&) noexcept = default;
+
+    /**
+     * @brief Loads the result stored under the provided key.
+     *
+     * @param key The key of the entry, e.g. a ContentHasher digest.
+     * @return The cached result, or std::nullopt on a miss.
+     */
+    std::optional<SimulationResult> load(const std::string& key) const;
+
+    /**
+     * @brief Stores a result under the provided key and evicts old entries if the cache grew too
+     * large. Failures are logged and otherwise ignored.
+     *
+     * @param key The key of the entry, e.g. a ContentHasher digest.
+     * @param result The result to store.
+     */
+    void store(const std::string& key, const SimulationResult& result) const;
+
+  private:
+    /**
+     * @brief Returns the path of the entry stored under the provided key.
+     *
+     * @param key The key of the entry.
+     * @return The path of the entry.
+     */
+    std::filesystem::path entryPath(const std::string& key) const;
+
+    /**
+     * @brief Removes the least recently used entries until the cache fits its size limit.
+     */
+    void evict() const;
+
+    std::filesystem::path m_cacheDir;
+    std::uintmax_t m_maxBytes;
+};
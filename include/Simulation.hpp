@@ -4,13 +4,31 @@
  * @brief This file contains the declaration of the Simulation class.
  */
 
+#include <functional>
 #include <memory>
 #include <opencv2/opencv.hpp>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "DensityMap.hpp"
+#include "NoiseModel.hpp"
 #include "RayTracer.hpp"
+#include "ReconstructionGrid.hpp"
 #include "SimulationResult.hpp"
+#include "SimulationShard.hpp"
+#include "SinogramArchive.hpp"
+#include "Spectrum.hpp"
+
+/**
+ * @enum AngleOrder
+ * @brief The order in which the projection angles of a scan are traced.
+ */
+enum class AngleOrder {
+    Sequential,   ///< Angles in increasing order.
+    BitReversed,  ///< Angle indices in bit-reversed order, halving the gaps every power of two.
+    GoldenAngle,  ///< Each angle advances by (approximately) the golden angle of ~137.5 degrees.
+};
 
 /**
  * @class Simulation
@@ -37,6 +55,17 @@ class Simulation {
      */
     Simulation(DensityMap&& densityMap);
 
+    /**
+     * @brief Constructs a polychromatic Simulation object with the provided density map and
+     * spectrum. Every ray is traced once and attenuated across all energy bins of the spectrum.
+     *
+     * @param densityMap The density map to use for the simulation.
+     * @param spectrum The spectrum of the simulated X-ray source.
+     * @see DensityMap
+     * @see Spectrum
+     */
+    Simulation(const DensityMap& densityMap, const Spectrum& spectrum);
+
     // Defaulted copy constructor and copy assignment operator
     Simulation(const Simulation&) = default;
     Simulation& operator=(const Simulation&) = default;
@@ -55,7 +84,205 @@ class Simulation {
     SimulationResult simulateCT(const std::size_t numAngles) const;
 
     /**
-     * @brief Simulates a projection for the specified angle.
+     * @brief Simulates a CT scan with the specified number of angles and reconstructs it on the
+     * provided grid, e.g. a region of interest or a lower resolution.
+     *
+     * @param numAngles The number of angles to use for the simulation.
+     * @param grid The grid to reconstruct the image on.
+     * @return A SimulationResult object containing the reconstructed image and projections.
+     * @see SimulationResult
+     * @see ReconstructionGrid
+     */
+    SimulationResult simulateCT(const std::size_t numAngles, const ReconstructionGrid& grid) const;
+
+    /**
+     * @brief Simulates a CT scan like simulateCT and additionally writes every unfiltered
+     * projection to a sinogram archive as soon as it is traced. The archive can be reconstructed
+     * later without tracing again.
+     *
+     * @param numAngles The number of angles to use for the simulation.
+     * @param grid The grid to reconstruct the image on.
+     * @param sinogramPath The path of the sinogram archive to write.
+     * @param encoding The encoding of the archived projections.
+     * @return A SimulationResult object containing the reconstructed image and projections.
+     * @see SinogramArchive
+     */
+    SimulationResult simulateCT(
+        const std::size_t numAngles,
+        const ReconstructionGrid& grid,
+        const std::string& sinogramPath,
+        const SinogramEncoding encoding
+    ) const;
+
+    /**
+     * @brief Callback receiving the reconstruction of one pyramid level. The first argument is
+     * the reconstruction, the second the level (0 is the finest).
+     */
+    using LevelCallback = std::function<void(const cv::Mat&, std::size_t)>;
+
+    /**
+     * @brief Simulates a CT scan and reconstructs it coarse to fine.
+     *
+     * The rays are traced once. The sinogram is then back-projected on the grid coarsened by
+     * 2^(numLevels - 1), 2^(numLevels - 2), ..., 2, and every level is handed to onLevel before the
+     * next, finer one is computed. All coarse levels together cost about a third of the finest.
+     *
+     * @param numAngles The number of angles to use for the simulation.
+     * @param grid The grid of the finest level.
+     * @param numLevels The number of levels including the finest.
+     * @param onLevel The callback receiving the coarse levels.
+     * @return A SimulationResult object containing the finest reconstruction and projections.
+     */
+    SimulationResult simulateCTPyramid(
+        const std::size_t numAngles,
+        const ReconstructionGrid& grid,
+        const std::size_t numLevels,
+        const LevelCallback& onLevel
+    ) const;
+
+    /**
+     * @brief Simulates a CT scan without holding the sinogram or the reconstruction in memory.
+     *
+     * Every projection is streamed to a Float64 sinogram archive as soon as it is traced. The
+     * archive is then memory-mapped and the image reconstructed tile by tile, with the tile size
+     * chosen so that the reconstruction state stays within the memory budget. Finished tiles are
+     * written straight to a TiledImage file. The tiles hold the same values as the
+     * reconstruction of simulateCT.
+     *
+     * @param numAngles The number of angles to use for the simulation.
+     * @param grid The grid to reconstruct the image on.
+     * @param sinogramPath The path of the sinogram archive to write.
+     * @param imagePath The path of the tiled image file to write.
+     * @param memoryBudget The memory available for the reconstruction in bytes.
+     * @see SinogramArchive
+     * @see TiledImage
+     */
+    void simulateCTOutOfCore(
+        const std::size_t numAngles,
+        const ReconstructionGrid& grid,
+        const std::string& sinogramPath,
+        const std::string& imagePath,
+        const std::size_t memoryBudget
+    ) const;
+
+    /**
+     * @brief Simulates a CT scan with the specified number of angles, overlapping ray tracing
+     * with reconstruction.
+     *
+     * A tracer thread pushes every projection into a bounded queue as soon as it is traced, while
+     * the calling thread back-projects it into a ReconstructionAccumulator. The sinogram
+     * normalization is applied to the accumulated image at the end, so the result equals that of
+     * simulateCT up to floating-point rounding.
+     *
+     * @param numAngles The number of angles to use for the simulation.
+     * @param queueDepth The maximum number of traced projections waiting for back-projection.
+     * @param grid The grid to reconstruct the image on.
+     * @return A SimulationResult object containing the reconstructed image and projections.
+     * @see SimulationResult
+     */
+    SimulationResult simulateCTPipelined(
+        const std::size_t numAngles, const std::size_t queueDepth, const ReconstructionGrid& grid
+    ) const;
+
+    /**
+     * @brief Callback receiving a partial reconstruction during a progressive simulation.
+     *
+     * The first argument is the reconstruction normalized with the projections seen so far, the
+     * second the number of projections it contains.
+     */
+    using SnapshotCallback = std::function<void(const cv::Mat&, std::size_t)>;
+
+    /**
+     * @brief Simulates a CT scan with the specified number of angles, accumulating every
+     * projection into the reconstruction as soon as it is traced.
+     *
+     * The angles are traced in the given order, so that early partial reconstructions are
+     * already spread over the full rotation. Every snapshotInterval projections the current
+     * reconstruction is handed to onSnapshot. The final result equals that of simulateCT up to
+     * floating-point rounding.
+     *
+     * @param numAngles The number of angles to use for the simulation.
+     * @param order The order in which the angles are traced.
+     * @param snapshotInterval The number of projections between two snapshots (0 disables them).
+     * @param onSnapshot The callback receiving the snapshots.
+     * @param grid The grid to reconstruct the image on.
+     * @return A SimulationResult object containing the reconstructed image and projections.
+     * @see SimulationResult
+     */
+    SimulationResult simulateCTProgressive(
+        const std::size_t numAngles,
+        const AngleOrder order,
+        const std::size_t snapshotInterval,
+        const SnapshotCallback& onSnapshot,
+        const ReconstructionGrid& grid
+    ) const;
+
+    /**
+     * @brief Simulates a CT scan once and reconstructs several noisy realizations of it.
+     *
+     * The rays are traced a single time. The noise realizations are then drawn from the noiseless
+     * sinogram and reconstructed as one batch, sharing the detector interpolation between them.
+     *
+     * @param numAngles The number of angles to use for the simulation.
+     * @param noiseModel The noise model used to generate the realizations.
+     * @param numRealizations The number of noise realizations.
+     * @return One SimulationResult per realization.
+     * @see NoiseModel
+     */
+    std::vector<SimulationResult> simulateCTNoiseRealizations(
+        const std::size_t numAngles,
+        const NoiseModel& noiseModel,
+        const std::size_t numRealizations
+    ) const;
+
+    /**
+     * @brief Simulates the angles [angleBegin, angleEnd) of a CT scan with numAngles angles.
+     *
+     * @param numAngles The total number of angles of the scan.
+     * @param angleBegin The index of the first angle to simulate.
+     * @param angleEnd The index one past the last angle to simulate.
+     * @param inputKey The hash of the scan's inputs, recorded in the shard.
+     * @return A SimulationShard object containing the projections and partial reconstruction.
+     * @see SimulationShard
+     */
+    SimulationShard simulateShard(
+        const std::size_t numAngles,
+        const std::size_t angleBegin,
+        const std::size_t angleEnd,
+        const std::string& inputKey
+    ) const;
+
+    /**
+     * @brief Simulates a CT scan and periodically checkpoints the completed projections, from
+     * which an interrupted run can be resumed.
+     *
+     * Every checkpointInterval angles, the projections completed since the previous checkpoint
+     * are appended to the checkpoint file (see SimulationCheckpoint); there is none after the last
+     * angle. A resumed run rebuilds the back-projection from the checkpointed projections in the
+     * same order as an uninterrupted one and produces the same result, which equals that of
+     * simulateCT up to floating-point rounding.
+     *
+     * @param numAngles The number of angles to simulate.
+     * @param checkpointInterval The number of angles between two checkpoints (0 disables them).
+     * @param checkpointPath The path of the checkpoint file.
+     * @param inputKey The hash of the scan's inputs. Checkpoints with another key are not resumed.
+     * @param resume Whether to continue from an existing checkpoint. Unusable checkpoints are
+     * ignored with a warning.
+     * @param grid The grid to reconstruct the image on.
+     * @return A SimulationResult object containing the reconstructed image and projections.
+     */
+    SimulationResult simulateCTCheckpointed(
+        const std::size_t numAngles,
+        const std::size_t checkpointInterval,
+        const std::string& checkpointPath,
+        const std::string& inputKey,
+        const bool resume,
+        const ReconstructionGrid& grid
+    ) const;
+
+    /**
+     * @brief Simulates a projection for the specified angle. With a spectrum, the projection is
+     * the polychromatic signal -ln(I / I0), otherwise the total density along each ray.
      *
      * @param phi The angle in radians.
      * @return The simulated projection.
@@ -69,7 +296,7 @@ class Simulation {
      * @param projections The projections to filter.
      * @return The filtered projections.
      */
-    cv::Mat& filterProjections(cv::Mat& projections) const;
+    static cv::Mat& filterProjections(cv::Mat& projections);
 
     /**
      * @brief This function back-projects the (filtered) projections to reconstruct the image.
@@ -79,7 +306,39 @@ class Simulation {
      */
     cv::Mat backProject(const cv::Mat& projections) const;
 
+    /**
+     * @brief This function back-projects the (filtered) projections onto the provided grid. The
+     * cost is proportional to the number of grid pixels.
+     *
+     * @param projections The (filtered) projections to back-project.
+     * @param grid The grid to reconstruct the image on.
+     * @return The reconstructed image (grid height x grid width).
+     */
+    cv::Mat backProject(const cv::Mat& projections, const ReconstructionGrid& grid) const;
+
+    /**
+     * @brief Returns the angle of the projection with the given index, when numAngles projections
+     * are distributed evenly over a full rotation.
+     *
+     * @param index The index of the projection.
+     * @param numAngles The total number of projections.
+     * @return The angle in radians.
+     */
+    static double angleForIndex(const std::size_t index, const std::size_t numAngles) noexcept;
+
+    /**
+     * @brief Returns the indices of numAngles projections in the given tracing order.
+     *
+     * @param numAngles The total number of projections.
+     * @param order The tracing order.
+     * @return A permutation of the indices 0 to numAngles - 1.
+     */
+    static std::vector<std::size_t> orderAngles(
+        const std::size_t numAngles, const AngleOrder order
+    );
+
   private:
     const DensityMap& m_densityMap;
     RayTracer m_rayTracer;
+    std::optional<Spectrum> m_spectrum;
 };
@@ -0,0 +1,76 @@
+#pragma once
+/**
+ * @file SimulationCheckpoint.hpp
+ * @brief This file contains the declaration of the SimulationCheckpoint class.
+ */
+
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <string>
+
+/**
+ * @class SimulationCheckpoint
+ * @brief Appends the completed projections of a scan to a checkpoint file, from which an
+ * interrupted scan can be resumed.
+ *
+ * The file starts with a header (magic, version, input key, number of angles and detector size),
+ * followed by blocks of projections in the order they were traced. A checkpoint only ever appends
+ * the projections completed since the last one, so the total size written grows linearly with the
+ * number of angles. The back-projection is not stored; a resumed scan rebuilds it from the
+ * projections. A block cut short by an interruption is ignored when loading.
+ */
+class SimulationCheckpoint {
+  public:
+    /**
+     * @brief Starts a checkpoint file holding the projections completed so far, replacing an
+     * existing one atomically.
+     *
+     * @param outputPath The path of the checkpoint file.
+     * @param inputKey The hash of the scan's inputs.
+     * @param numAngles The total number of angles of the scan.
+     * @param completed The projections completed so far (detectorSize x number of angles).
+     */
+    SimulationCheckpoint(
+        const std::string& outputPath,
+        const std::string& inputKey,
+        const std::size_t numAngles,
+        const cv::Mat& completed
+    );
+
+    // The file is owned and is not copyable
+    SimulationCheckpoint(const SimulationCheckpoint&) = delete;
+    SimulationCheckpoint& operator=(const SimulationCheckpoint&) = delete;
+
+    // Default move constructor and move assignment operator
+    SimulationCheckpoint(SimulationCheckpoint&&) noexcept = default;
+    SimulationCheckpoint& operator=(SimulationCheckpoint&&) noexcept = default;
+
+    /**
+     * @brief Appends the projections completed since the last checkpoint and flushes the file.
+     * Throws std::runtime_error if the write fails.
+     *
+     * @param projections The projections (detectorSize x number of new angles).
+     */
+    void append(const cv::Mat& projections);
+
+    /**
+     * @brief Loads the projections of a checkpoint file. Throws std::runtime_error if the file is
+     * not a checkpoint of the given scan.
+     *
+     * @param inputPath The path of the checkpoint file.
+     * @param inputKey The hash of the scan's inputs.
+     * @param numAngles The total number of angles of the scan.
+     * @param detectorSize The number of values per projection.
+     * @return The completed projections (detectorSize x number of completed angles, CV_64F).
+     */
+    static cv::Mat load(
+        const std::string& inputPath,
+        const std::string& inputKey,
+        const std::size_t numAngles,
+        const std::size_t detectorSize
+    );
+
+  private:
+    std::string m_outputPath;
+    std::ofstream m_file;
+};
@@ -0,0 +1,162 @@
+#pragma once
+/**
+ * @file SimulationServer.hpp
+ * @brief This file contains the declaration of the SimulationServer class.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BoundedQueue.hpp"
+#include "ImageWriter.hpp"
+#include "Simulation.hpp"
+
+/**
+ * @class SimulationServer
+ * @brief Serves simulation jobs over a Unix domain socket from a resident process, so that many
+ * small jobs do not each pay process startup, image loading and thread creation.
+ *
+ * A client connects, sends one request line and receives one response line once all outputs of
+ * the job are written. A request is a list of key=value pairs separated by spaces:
+ *
+ *     input=<image> output=<directory> angles=<n> [formats=png8,raw]
+ *     shm=<name> size=<n> output=<directory> angles=<n> [formats=png8,raw]
+ *
+ * With shm, the density map is read from the POSIX shared memory object of that name, holding an
+ * n x n 8-bit grayscale image. The response is "ok <milliseconds>" or "error <message>". The
+ * request "shutdown" stops the server once the queued jobs are done.
+ *
+ * Request lines are read without blocking; a connection that sends none within a few seconds is
+ * answered with an error. Accepted jobs are queued and processed by a fixed pool of worker
+ * threads. When the queue is full, a request is answered with "error busy: ..." right away, so
+ * the client can retry later. A worker takes up to maxBatch queued jobs at once and simulates
+ * identical jobs (same input and angles) only once. The simulations of input files stay loaded in
+ * an LRU cache, keyed by path and modification time, and output images are encoded on a shared
+ * ImageWriter.
+ */
+class SimulationServer {
+  public:
+    /**
+     * @brief Constructs a SimulationServer object. The socket is created by run.
+     *
+     * @param socketPath The path of the Unix domain socket to listen on.
+     * @param numWorkers The number of worker threads. A value of 0 is treated as 1.
+     * @param queueDepth The maximum number of queued jobs before requests are rejected as busy.
+     * @param maxBatch The maximum number of jobs a worker takes at once.
+     * @param cacheEntries The number of loaded input files kept in memory.
+     */
+    SimulationServer(
+        const std::string& socketPath,
+        const std::size_t numWorkers,
+        const std::size_t queueDepth,
+        const std::size_t maxBatch,
+        const std::size_t cacheEntries
+    );
+
+    // The server owns threads and sockets and is neither copyable nor movable
+    SimulationServer(const SimulationServer&) = delete;
+    SimulationServer& operator=(const SimulationServer&) = delete;
+
+    /**
+     * @brief Listens on the socket and serves jobs until a shutdown request is received. Throws
+     * std::runtime_error if the socket cannot be created.
+     */
+    void run();
+
+  private:
+    /**
+     * @brief A queued simulation job.
+     */
+    struct Job {
+        int client;  ///< The connection the response is sent on.
+        std::string inputPath;
+        std::string shmName;
+        std::size_t shmSize;
+        std::string outputPath;
+        std::size_t angles;
+        std::vector<OutputFormat> formats;
+        std::chrono::steady_clock::time_point received;
+
+        /**
+         * @brief Returns a key that is equal for jobs with the same simulation result.
+         */
+        std::string resultKey() const;
+    };
+
+    /**
+     * @brief A loaded input together with its simulation.
+     */
+    struct Input {
+        explicit Input(DensityMap&& densityMap);
+
+        // The simulation refers to the density map of this object, so it is not copyable
+        Input(const Input&) = delete;
+        Input& operator=(const Input&) = delete;
+
+        DensityMap densityMap;
+        Simulation simulation;
+    };
+
+    /**
+     * @brief Parses a request line into a job. Throws std::invalid_argument on invalid requests.
+     *
+     * @param request The request line without the line break.
+     * @return The parsed job.
+     */
+    static Job parseRequest(const std::string& request);
+
+    /**
+     * @brief Parses a request and queues its job, or answers the client with an error if the
+     * request is invalid or the queue is full.
+     *
+     * @param client The connection the request was received on.
+     * @param request The request line.
+     */
+    void queue(int client, const std::string& request);
+
+    /**
+     * @brief Processes batches of queued jobs until the queue is closed. Runs on a worker thread.
+     */
+    void work();
+
+    /**
+     * @brief Simulates a job, loading its input from the cache, a file or shared memory.
+     *
+     * @param job The job to simulate.
+     * @return The result of the job.
+     */
+    SimulationResult simulate(const Job& job);
+
+    /**
+     * @brief Returns an input file, loading it on a cache miss.
+     *
+     * @param inputPath The path of the input image.
+     * @return The loaded input.
+     */
+    std::shared_ptr<const Input> cachedInput(const std::string& inputPath);
+
+    /**
+     * @brief Writes the outputs of a job and waits until they are written.
+     *
+     * @param job The job to write the outputs of.
+     * @param result The result of the job.
+     */
+    void save(const Job& job, const SimulationResult& result);
+
+    std::string m_socketPath;
+    std::size_t m_numWorkers;
+    std::size_t m_maxBatch;
+    std::size_t m_cacheEntries;
+
+    BoundedQueue<Job> m_jobs;
+    ImageWriter m_writer;
+
+    std::mutex m_cacheMutex;
+    std::list<std::pair<std::string, std::shared_ptr<const Input>>> m_cache;
+};
@@ -0,0 +1,128 @@
+#pragma once
+/**
+ * @file SimulationShard.hpp
+ * @brief This file contains the declaration of the SimulationShard class.
+ */
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "ReconstructionAccumulator.hpp"
+#include "SimulationResult.hpp"
+
+/**
+ * @class SimulationShard
+ * @brief This class represents the partial result of a CT simulation that only traced a
+ * contiguous range of the scan's angles.
+ *
+ * A shard holds the unfiltered projections of its angles and the partial back-projection of
+ * them, together with the input key of the scan (the hash of its inputs the result cache uses).
+ * Shards of the same scan covering all of its angles can be merged without tracing again, into a
+ * result that equals that of simulateCT up to floating-point rounding.
+ */
+class SimulationShard {
+  public:
+    /**
+     * @brief Constructs a SimulationShard object by moving the provided partial results.
+     *
+     * @param inputKey The hash of the scan's inputs, identifying the shards of one scan.
+     * @param numAngles The total number of angles of the scan.
+     * @param angleBegin The index of the first angle of the shard.
+     * @param angleEnd The index one past the last angle of the shard.
+     * @param projections The unfiltered projections of the shard (imageSize x number of angles).
+     * @param accumulator The back-projection of the shard's projections.
+     */
+    SimulationShard(
+        const std::string& inputKey,
+        const std::size_t numAngles,
+        const std::size_t angleBegin,
+        const std::size_t angleEnd,
+        cv::Mat&& projections,
+        ReconstructionAccumulator&& accumulator
+    );
+
+    // Default copy constructor and copy assignment operator
+    SimulationShard(const SimulationShard&) = default;
+    SimulationShard& operator=(const SimulationShard&) = default;
+
+    // Default move constructor and move assignment operator
+    SimulationShard(SimulationShard&&) noexcept = default;
+    SimulationShard& operator=(SimulationShard&&) noexcept = default;
+
+    /**
+     * @brief Returns the hash of the scan's inputs.
+     *
+     * @return The input key.
+     */
+    const std::string& getInputKey() const noexcept;
+
+    /**
+     * @brief Returns the total number of angles of the scan.
+     *
+     * @return The total number of angles.
+     */
+    std::size_t getNumAngles() const noexcept;
+
+    /**
+     * @brief Returns the index of the first angle of the shard.
+     *
+     * @return The index of the first angle.
+     */
+    std::size_t getAngleBegin() const noexcept;
+
+    /**
+     * @brief Returns the index one past the last angle of the shard.
+     *
+     * @return The index one past the last angle.
+     */
+    std::size_t getAngleEnd() const noexcept;
+
+    /**
+     * @brief Returns the unfiltered projections of the shard.
+     *
+     * @return The projections (imageSize x number of angles of the shard).
+     */
+    const cv::Mat& getProjections() const noexcept;
+
+    /**
+     * @brief Returns the back-projection of the shard's projections.
+     *
+     * @return The partial reconstruction.
+     */
+    const ReconstructionAccumulator& getAccumulator() const noexcept;
+
+    /**
+     * @brief Saves the shard to the specified path. The file is written to a temporary path first
+     * and renamed, so a partially written shard is never picked up.
+     *
+     * @param outputPath The path to save the shard to.
+     */
+    void save(const std::string& outputPath) const;
+
+    /**
+     * @brief Loads a shard saved by save.
+     *
+     * @param inputPath The path to load the shard from.
+     * @return The loaded shard.
+     */
+    static SimulationShard load(const std::string& inputPath);
+
+    /**
+     * @brief Merges shards into the result of the full scan. The sinograms are concatenated and
+     * the partial back-projections summed.
+     *
+     * @param shards The shards to merge. They must have the same input key and together cover
+     * every angle exactly once. The shards are left unchanged.
+     * @return A SimulationResult object containing the reconstructed image and projections.
+     */
+    static SimulationResult merge(const std::vector<SimulationShard>& shards);
+
+  private:
+    std::string m_inputKey;
+    std::size_t m_numAngles;
+    std::size_t m_angleBegin;
+    std::size_t m_angleEnd;
+    cv::Mat m_projections;
+    ReconstructionAccumulator m_accumulator;
+};
@@ -0,0 +1,168 @@
+#pragma once
+/**
+ * @file SinogramArchive.hpp
+ * @brief This file contains the declarations of the SinogramWriter and SinogramArchive classes.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <string>
+
+#include "MappedFile.hpp"
+
+/**
+ * @enum SinogramEncoding
+ * @brief The encodings projections can be stored with in a sinogram archive.
+ */
+enum class SinogramEncoding : uint32_t {
+    Float64,  ///< Raw CV_64F values. Lossless and read without copying.
+    Float32,  ///< Raw CV_32F values. Half the size and read without copying.
+    Delta,    ///< Lossless differences of consecutive CV_64F bit patterns as zigzag varints.
+};
+
+/**
+ * @class SinogramWriter
+ * @brief Writes the projections of a scan to a sinogram archive one angle at a time.
+ *
+ * An archive starts with a header (magic, version, detector size, number of angles and encoding),
+ * padded to 64 bytes, followed by an index holding the angle, offset and size of every
+ * projection, so any projection can be found without reading the others. The projections
+ * follow, each starting at a multiple of 8 bytes. Every append writes its projection and index
+ * entry right away, so a scan never has to hold its sinogram in memory. The file is written to a
+ * temporary path and renamed by finish. If a write fails or the writer is destroyed before
+ * finish, the temporary file is removed.
+ */
+class SinogramWriter {
+  public:
+    /**
+     * @brief Creates a sinogram archive for writing.
+     *
+     * @param outputPath The path of the finished archive.
+     * @param detectorSize The number of values per projection.
+     * @param numAngles The number of projections the archive will hold.
+     * @param encoding The encoding of the projections.
+     */
+    SinogramWriter(
+        const std::string& outputPath,
+        const std::size_t detectorSize,
+        const std::size_t numAngles,
+        const SinogramEncoding encoding
+    );
+
+    // The file is owned and is not copyable
+    SinogramWriter(const SinogramWriter&) = delete;
+    SinogramWriter& operator=(const SinogramWriter&) = delete;
+
+    // Custom move constructor and move assignment operator, the moved-from writer owns no file
+    SinogramWriter(SinogramWriter&& other) noexcept;
+    SinogramWriter& operator=(SinogramWriter&& other) noexcept;
+
+    /**
+     * @brief Removes the temporary file of an archive that was not finished.
+     */
+    ~SinogramWriter();
+
+    /**
+     * @brief Appends the next projection. Throws std::invalid_argument if the archive is full or
+     * the projection has the wrong size, and std::runtime_error if the write fails.
+     *
+     * @param projection The single-column projection (detectorSize x 1).
+     * @param phi The angle of the projection in radians.
+     */
+    void append(const cv::Mat& projection, const double phi);
+
+    /**
+     * @brief Flushes the archive and renames it to its final path. Throws std::runtime_error if
+     * not all projections have been appended or the write fails.
+     */
+    void finish();
+
+  private:
+    /**
+     * @brief Closes and removes the temporary file, if the writer still owns one.
+     */
+    void discard() noexcept;
+
+    std::string m_outputPath;
+    std::string m_tmpPath;
+    std::ofstream m_file;
+    std::size_t m_detectorSize;
+    std::size_t m_numAngles;
+    SinogramEncoding m_encoding;
+    std::size_t m_numWritten;
+    std::uint64_t m_dataEnd;
+};
+
+/**
+ * @class SinogramArchive
+ * @brief Reads a sinogram archive written by SinogramWriter through a memory mapping.
+ *
+ * Only the header and index are validated on opening. Projections are located through the index
+ * in constant time and, unless delta-coded, returned as matrices referring directly to the
+ * mapping.
+ */
+class SinogramArchive {
+  public:
+    /**
+     * @brief Opens a sinogram archive. Throws std::runtime_error if the file is not a valid
+     * archive.
+     *
+     * @param inputPath The path of the archive.
+     */
+    explicit SinogramArchive(const std::string& inputPath);
+
+    // The mapping is owned and is not copyable
+    SinogramArchive(const SinogramArchive&) = delete;
+    SinogramArchive& operator=(const SinogramArchive&) = delete;
+
+    // Default move constructor and move assignment operator
+    SinogramArchive(SinogramArchive&&) noexcept = default;
+    SinogramArchive& operator=(SinogramArchive&&) noexcept = default;
+
+    /**
+     * @brief Returns the number of values per projection.
+     *
+     * @return The detector size.
+     */
+    std::size_t getDetectorSize() const noexcept;
+
+    /**
+     * @brief Returns the number of projections in the archive.
+     *
+     * @return The number of angles.
+     */
+    std::size_t getNumAngles() const noexcept;
+
+    /**
+     * @brief Returns the encoding of the projections.
+     *
+     * @return The encoding.
+     */
+    SinogramEncoding getEncoding() const noexcept;
+
+    /**
+     * @brief Returns the angle of a projection.
+     *
+     * @param index The index of the projection.
+     * @return The angle in radians.
+     */
+    double angle(const std::size_t index) const;
+
+    /**
+     * @brief Returns a projection as a detectorSize x 1 matrix. Float64 and Float32 projections
+     * refer to the mapping and stay valid as long as the archive; delta-coded ones are decoded
+     * into a new CV_64F matrix.
+     *
+     * @param index The index of the projection.
+     * @return The projection, CV_32F for Float32 archives and CV_64F otherwise.
+     */
+    cv::Mat projection(const std::size_t index) const;
+
+  private:
+    MappedFile m_file;
+    std::size_t m_detectorSize;
+    std::size_t m_numAngles;
+    SinogramEncoding m_encoding;
+};
@@ -0,0 +1,76 @@
+#pragma once
+/**
+ * @file Spectrum.hpp
+ * @brief This file contains the declaration of the Spectrum class.
+ */
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @class Spectrum
+ * @brief This class represents a polychromatic X-ray spectrum, split into energy bins, together
+ * with the attenuation coefficients of the materials in the density map.
+ *
+ * Spectrum files are plain text. Empty lines and lines starting with '#' are ignored. An optional
+ * line `materials <b_0> <b_1> ...` assigns every pixel to the first material whose upper density
+ * bound b_m is not below its density (default: a single material). Every other line describes one
+ * energy bin as `<energy> <weight> <mu_0> <mu_1> ...`, with one attenuation coefficient per
+ * material, given per unit density and pixel length.
+ */
+class Spectrum {
+  public:
+    /**
+     * @brief Constructs a Spectrum object by loading the spectrum from the provided file. Throws
+     * std::runtime_error if the file cannot be read or is malformed.
+     *
+     * @param spectrumPath The path to the spectrum file.
+     */
+    Spectrum(const std::string& spectrumPath);
+
+    // Default copy constructor and copy assignment operator
+    Spectrum(const Spectrum&) = default;
+    Spectrum& operator=(const Spectrum&) = default;
+
+    // Default move constructor and move assignment operator
+    Spectrum(Spectrum&&) noexcept = default;
+    Spectrum& operator=(Spectrum&&) noexcept = default;
+
+    /**
+     * @brief Returns the upper density bounds of the materials in ascending order.
+     *
+     * @return The upper density bound of each material.
+     */
+    const std::vector<double>& getMaterialBounds() const noexcept;
+
+    /**
+     * @brief Returns the number of energy bins.
+     *
+     * @return The number of energy bins.
+     */
+    std::size_t getNumBins() const noexcept;
+
+    /**
+     * @brief Computes the detector signal for a set of rays from their path lengths through each
+     * material, by applying Beer-Lambert attenuation in every energy bin and integrating over the
+     * spectrum.
+     *
+     * @param pathLengths The density-weighted path lengths (numRays x numMaterials, CV_64F).
+     * @return The projection -ln(I / I0) for every ray (numRays x 1, CV_64F).
+     */
+    cv::Mat attenuate(const cv::Mat& pathLengths) const;
+
+    /**
+     * @brief Loads the spectrum from the provided file. Every token must be a number and every
+     * weight non-negative. Throws std::runtime_error if the file cannot be read or is malformed.
+     *
+     * @param spectrumPath The path to the spectrum file.
+     */
+    void loadFromFilepath(const std::string& spectrumPath);
+
+  private:
+    std::vector<double> m_materialBounds;
+    cv::Mat m_attenuation;  ///< Negated attenuation coefficients (numMaterials x numBins).
+    cv::Mat m_weights;      ///< Bin weights normalized to a sum of 1 (numBins x 1).
+};
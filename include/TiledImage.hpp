@@ -0,0 +1,111 @@
+#pragma once
+/**
+ * @file TiledImage.hpp
+ * @brief This file contains the declaration of the TiledImage class.
+ */
+
+#include <cstddef>
+#include <fstream>
+#include <opencv2/opencv.hpp>
+#include <string>
+
+/**
+ * @class TiledImage
+ * @brief Writes a 32-bit floating-point image tile by tile to a file, so that images larger than
+ * the available memory can be produced one tile at a time.
+ *
+ * The file starts with a header (magic, version, width, height and tile size), padded to 64 bytes,
+ * followed by the tiles in row-major order. Every tile occupies tileSize x tileSize values, tiles
+ * at the right and bottom edges are padded with zeros, so the offset of each tile is known up
+ * front and tiles can be written in any order. The file is written to a temporary path and renamed
+ * by finish.
+ */
+class TiledImage {
+  public:
+    /**
+     * @brief Creates a tiled image file for writing.
+     *
+     * @param outputPath The path of the finished file.
+     * @param width The width of the image.
+     * @param height The height of the image.
+     * @param tileSize The width and height of a tile.
+     */
+    TiledImage(
+        const std::string& outputPath,
+        const std::size_t width,
+        const std::size_t height,
+        const std::size_t tileSize
+    );
+
+    // The file is owned and is not copyable
+    TiledImage(const TiledImage&) = delete;
+    TiledImage& operator=(const TiledImage&) = delete;
+
+    // Default move constructor and move assignment operator
+    TiledImage(TiledImage&&) noexcept = default;
+    TiledImage& operator=(TiledImage&&) noexcept = default;
+
+    /**
+     * @brief Returns the number of tiles per row.
+     *
+     * @return The number of tile columns.
+     */
+    std::size_t getTilesX() const noexcept;
+
+    /**
+     * @brief Returns the number of tiles per column.
+     *
+     * @return The number of tile rows.
+     */
+    std::size_t getTilesY() const noexcept;
+
+    /**
+     * @brief Returns the region of the image covered by a tile, clipped to the image.
+     *
+     * @param tileX The column of the tile.
+     * @param tileY The row of the tile.
+     * @return The region of the tile in image pixels.
+     */
+    cv::Rect tileRegion(const std::size_t tileX, const std::size_t tileY) const;
+
+    /**
+     * @brief Writes a tile. Throws std::runtime_error if the write fails.
+     *
+     * @param tileX The column of the tile.
+     * @param tileY The row of the tile.
+     * @param tile The single-channel tile data, sized like tileRegion. Converted to 32 bits.
+     */
+    void writeTile(const std::size_t tileX, const std::size_t tileY, const cv::Mat& tile);
+
+    /**
+     * @brief Flushes the file and renames it to its final path. Throws std::runtime_error on
+     * failure.
+     */
+    void finish();
+
+    /**
+     * @brief Reads the size of the image stored in a tiled image file.
+     *
+     * @param inputPath The path of the tiled image file.
+     * @return The width and height of the image.
+     */
+    static cv::Size readSize(const std::string& inputPath);
+
+    /**
+     * @brief Reads a region of a tiled image file. Only the tiles overlapping the region are
+     * read, so the cost is proportional to the region.
+     *
+     * @param inputPath The path of the tiled image file.
+     * @param region The region to read in image pixels. Must lie within the image.
+     * @return The region as a CV_32F matrix.
+     */
+    static cv::Mat readRegion(const std::string& inputPath, const cv::Rect& region);
+
+  private:
+    std::string m_outputPath;
+    std::string m_tmpPath;
+    std::ofstream m_file;
+    std::size_t m_width;
+    std::size_t m_height;
+    std::size_t m_tileSize;
+};
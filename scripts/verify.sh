@@ -0,0 +1,182 @@
+#!/usr/bin/env bash
+
+# End-to-end checks of a built ct_ray_sim binary. Every check runs the binary on the input image
+# in a temporary directory and compares the outputs of different modes that must agree. The modes
+# only promise equal results up to floating-point rounding, so outputs are compared with the
+# compare subcommand within a tolerance relative to their value range.
+#
+# Usage: ./scripts/verify.sh [BINARY] [INPUT]
+
+BINARY="${1:-build/ct_ray_sim}"
+INPUT="${2:-input.png}"
+ANGLES=32
+
+# One gray level of an 8-bit PNG, and the rounding of 32-bit floats accumulated over the angles
+PNG8_TOLERANCE=0.004
+RAW_TOLERANCE=1e-5
+
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+FAILURES=0
+
+# Function to run the binary inside the work directory (it saves a debug image to the current
+# directory), with its log appended to the work directory's log
+run() {
+    (cd "$WORK_DIR" && "$BINARY" "$@" >> "$WORK_DIR/log.txt" 2>&1)
+}
+
+# Function to record a failed check
+fail() {
+    echo "FAILED: $1"
+    FAILURES=$((FAILURES + 1))
+}
+
+# Splitting a scan into shards and merging them must reproduce the full scan
+check_shards() {
+    echo "Checking split-then-merge..."
+    local half=$((ANGLES / 2 + 3))
+
+    run --inputPath "$INPUT" --outputPath "$WORK_DIR/full" --angles "$ANGLES" \
+        || { fail "full scan"; return; }
+    run --inputPath "$INPUT" --outputPath "$WORK_DIR/shards" --angles "$ANGLES" \
+        --angleRange "0:$half" || { fail "first shard"; return; }
+    run --inputPath "$INPUT" --outputPath "$WORK_DIR/shards" --angles "$ANGLES" \
+        --angleRange "$half:$ANGLES" || { fail "second shard"; return; }
+
+    # The shards are given out of order on purpose
+    run merge --outputPath "$WORK_DIR/merged" \
+        "$WORK_DIR/shards/shard_${half}_${ANGLES}.bin" "$WORK_DIR/shards/shard_0_${half}.bin" \
+        || { fail "merge"; return; }
+
+    for image in projections.png reconstructed_image.png; do
+        run compare --tolerance "$PNG8_TOLERANCE" "$WORK_DIR/full/$image" \
+            "$WORK_DIR/merged/$image" || fail "merged $image differs from the full scan"
+    done
+
+    # A shard of a scan with other inputs (here a spectrum) must be rejected
+    echo "60 1 0.2" > "$WORK_DIR/spectrum.txt"
+    run --inputPath "$INPUT" --outputPath "$WORK_DIR/other" --angles "$ANGLES" \
+        --spectrum "$WORK_DIR/spectrum.txt" --angleRange "$half:$ANGLES" \
+        || { fail "shard with spectrum"; return; }
+
+    if run merge --outputPath "$WORK_DIR/mixed" \
+        "$WORK_DIR/shards/shard_0_${half}.bin" "$WORK_DIR/other/shard_${half}_${ANGLES}.bin" \
+        2> /dev/null; then
+        fail "merge accepted shards of different scans"
+    fi
+}
+
+# An out-of-core reconstruction exported from its tiles must equal the in-memory one
+check_tiles() {
+    echo "Checking out-of-core tiles..."
+
+    run --inputPath "$INPUT" --outputPath "$WORK_DIR/in_memory" --angles "$ANGLES" \
+        --outputFormat raw || { fail "in-memory scan"; return; }
+    run --inputPath "$INPUT" --outputPath "$WORK_DIR/out_of_core" --angles "$ANGLES" \
+        --outOfCore --memoryBudget 1 || { fail "out-of-core scan"; return; }
+    run export --outputPath "$WORK_DIR/exported" --outputFormat raw \
+        "$WORK_DIR/out_of_core/reconstructed_image.tiles" || { fail "export"; return; }
+
+    run compare --tolerance "$RAW_TOLERANCE" "$WORK_DIR/in_memory/reconstructed_image.raw" \
+        "$WORK_DIR/exported/reconstructed_image.raw" \
+        || fail "exported tiles differ from the in-memory reconstruction"
+
+    run export --outputPath "$WORK_DIR/preview" --roi 0,0,16,16 --downsample 4 \
+        "$WORK_DIR/out_of_core/reconstructed_image.tiles" || fail "downsampled export"
+}
+
+# A failed write must make the command fail
+check_failed_writes() {
+    echo "Checking failed writes..."
+
+    # A directory in place of an output image makes its write fail
+    mkdir -p "$WORK_DIR/blocked/reconstructed_image.png/blocked"
+    if run --inputPath "$INPUT" --outputPath "$WORK_DIR/blocked" --angles "$ANGLES"; then
+        fail "failed write reported success"
+    fi
+}
+
+# Function to send a request line to the server and print its response
+request() {
+    echo "$1" | socat - "UNIX-CONNECT:$WORK_DIR/serve.sock"
+}
+
+# A served job must answer ok once its outputs are written, and report a failed write as an error
+check_serve() {
+    if ! command -v socat &> /dev/null; then
+        echo "Skipping serve checks, socat is not installed."
+        return
+    fi
+
+    echo "Checking serve..."
+    run serve --socket "$WORK_DIR/serve.sock" --workers 1 &
+    local server=$!
+
+    for _ in $(seq 50); do
+        [ -S "$WORK_DIR/serve.sock" ] && break
+        sleep 0.1
+    done
+
+    local response
+    response="$(request "input=$INPUT output=$WORK_DIR/served angles=$ANGLES")"
+    [[ "$response" == ok* ]] || fail "served job answered '$response'"
+
+    # A directory in place of an output image makes its write fail
+    mkdir -p "$WORK_DIR/unwritable/projections.png/blocked"
+    response="$(request "input=$INPUT output=$WORK_DIR/unwritable angles=$ANGLES")"
+    [[ "$response" == error* ]] || fail "failed write answered '$response'"
+
+    request "shutdown" > /dev/null
+    wait "$server" || fail "serve exit status"
+}
+
+# Options that would silently be ignored in combination must be rejected
+check_rejected_options() {
+    echo "Checking rejected option combinations..."
+    local combinations=(
+        "--pipeline --progressive"
+        "--pyramid 2 --checkpointEvery 4"
+        "--realizations 2 --roi 0,0,8,8"
+        "--angleRange 0:4 --outputScale 0.5"
+        "--cacheDir cache --pyramid 2"
+        "--sinogram delta --pipeline"
+        "--cacheDir cache --sinogram delta"
+    )
+
+    for options in "${combinations[@]}"; do
+        if run --inputPath "$INPUT" --outputPath "$WORK_DIR/rejected" --angles "$ANGLES" \
+            $options; then
+            fail "accepted $options"
+        fi
+    done
+}
+
+# Main script logic
+main() {
+    if [ ! -x "$BINARY" ] || [ ! -f "$INPUT" ]; then
+        echo "Usage: ./scripts/verify.sh [BINARY] [INPUT]"
+        echo "Error: '$BINARY' is not executable or '$INPUT' does not exist."
+        exit 1
+    fi
+
+    BINARY="$(realpath "$BINARY")"
+    INPUT="$(realpath "$INPUT")"
+
+    check_shards
+    check_tiles
+    check_failed_writes
+    check_serve
+    check_rejected_options
+
+    if [ "$FAILURES" -ne 0 ]; then
+        echo "$FAILURES check(s) failed. Log:"
+        cat "$WORK_DIR/log.txt"
+        exit 1
+    fi
+
+    echo "All checks passed."
+}
+
+# Invoke the main function with all passed arguments
+main "$@"
@@ -0,0 +1,72 @@
+#include "ContentHasher.hpp"
+
+#include <fmt/core.h>
+
+#include <cstring>
+
+using std::size_t;
+using std::uint64_t;
+
+namespace {
+
+/**
+ * @brief The SplitMix64 finalizer, a bijective 64-bit mixing function.
+ */
+constexpr uint64_t mix64(uint64_t x) noexcept {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+}  // namespace
+
+ContentHasher::ContentHasher()
+    : m_state{ 0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL },
+      m_length(0) { }
+
+ContentHasher& ContentHasher::update(const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    m_length += size;
+
+    // Two independent lanes absorb the input one 64-bit word at a time
+    const auto absorb = [this](uint64_t word) {
+        m_state[0] = mix64(m_state[0] ^ word) + 0x9e3779b97f4a7c15ULL;
+        m_state[1] = mix64(m_state[1] + word * 0xff51afd7ed558ccdULL) ^ m_state[0];
+    };
+
+    for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), bytes += sizeof(uint64_t)) {
+        auto word = uint64_t(0);
+        std::memcpy(&word, bytes, sizeof(word));
+        absorb(word);
+    }
+
+    if (size > 0) {
+        auto word = uint64_t(0);
+        std::memcpy(&word, bytes, size);
+        absorb(word ^ (uint64_t(size) << 56));
+    }
+
+    return *this;
+}
+
+ContentHasher& ContentHasher::update(const std::string& value) {
+    update<uint64_t>(value.size());
+    return update(value.data(), value.size());
+}
+
+ContentHasher& ContentHasher::update(const cv::Mat& mat) {
+    update<int32_t>(mat.rows);
+    update<int32_t>(mat.cols);
+    update<int32_t>(mat.type());
+
+    const auto rowBytes = mat.cols * mat.elemSize();
+    for (int32_t row = 0; row < mat.rows; ++row) update(mat.ptr(row), rowBytes);
+
+    return *this;
+}
+
+std::string ContentHasher::hexDigest() const {
+    const auto high = mix64(m_state[0] ^ m_length);
+    const auto low = mix64(m_state[1] ^ high);
+    return fmt::format("{:016x}{:016x}", high, low);
+}
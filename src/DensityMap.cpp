@@ -13,6 +13,10 @@ DensityMap::DensityMap(std::string&& imagePath) : m_densityMap(), m_imageSize(0)
     loadFromFilepath(imagePath);
 }
 
+DensityMap::DensityMap(const cv::Mat& image) : m_densityMap(), m_imageSize(0) {
+    loadFromImage(image);
+}
+
 double DensityMap::getDensity(std::size_t x, std::size_t y) const noexcept {
     if (x >= m_imageSize || y >= m_imageSize) {
         spdlog::warn("Access out of bounds at ({}, {}), returning 0.0", x, y);
@@ -29,16 +33,32 @@ std::size_t DensityMap::getSize() const noexcept {
     return m_imageSize;
 }
 
+const cv::Mat& DensityMap::getData() const noexcept {
+    return m_densityMap;
+}
+
 void DensityMap::loadFromFilepath(const std::string& imagePath) {
     spdlog::info("Loading image from: {}", imagePath);
-    m_densityMap = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
+    const auto image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
 
-    if (m_densityMap.empty()) {
+    if (image.empty()) {
         spdlog::error("Failed to load image: {}", imagePath);
         std::exit(EXIT_FAILURE);
     }
 
-    m_densityMap.convertTo(m_densityMap, CV_64F, 1.0 / 255.0);
+    loadFromImage(image);
+
+    cv::Mat density_display;
+    m_densityMap.convertTo(density_display, CV_8U, 255.0);
+
+    if (cv::imwrite("debug_density_map.png", density_display))
+        spdlog::info("Saved debug density map as 'debug_density_map.png'.");
+    else
+        spdlog::error("Failed to save debug density map as 'debug_density_map.png'.");
+}
+
+void DensityMap::loadFromImage(const cv::Mat& image) {
+    image.convertTo(m_densityMap, CV_64F, 1.0 / 255.0);
     spdlog::debug("Image loaded and converted to CV_64F with scaling.");
 
     if (m_densityMap.rows != m_densityMap.cols) {
@@ -64,12 +84,4 @@ void DensityMap::loadFromFilepath(const std::string& imagePath) {
             spdlog::debug("{}", row);
         }
     }
-
-    cv::Mat density_display;
-    m_densityMap.convertTo(density_display, CV_8U, 255.0);
-
-    if (cv::imwrite("debug_density_map.png", density_display))
-        spdlog::info("Saved debug density map as 'debug_density_map.png'.");
-    else
-        spdlog::error("Failed to save debug density map as 'debug_density_map.png'.");
 }
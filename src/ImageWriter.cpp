@@ -0,0 +1,113 @@
+#include "ImageWriter.hpp"
+
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+#include "MatIO.hpp"
+#include "PostProcessing.hpp"
+
+namespace fs = std::filesystem;
+
+using std::size_t;
+
+ImageWriter::ImageWriter(std::size_t numThreads)
+    : m_queue(2 * std::max(numThreads, size_t(1))),
+      m_threads() {
+    for (size_t i = 0; i < std::max(numThreads, size_t(1)); ++i) {
+        m_threads.emplace_back([this] {
+            while (auto task = m_queue.pop()) (*task)();
+        });
+    }
+}
+
+ImageWriter::~ImageWriter() {
+    join();
+}
+
+void ImageWriter::join() {
+    m_queue.close();
+    for (auto& thread : m_threads)
+        if (thread.joinable()) thread.join();
+}
+
+std::future<void> ImageWriter::write(
+    const cv::Mat& image, const std::string& outputPath, const OutputFormat format
+) {
+    auto task = std::packaged_task<void()>([image, outputPath, format] {
+        writeNow(image, outputPath + suffixFor(format), format);
+    });
+    auto written = task.get_future();
+
+    if (!m_queue.push(std::move(task))) {
+        spdlog::error("Cannot write '{}' after the image writer was joined.", outputPath);
+        throw std::logic_error("Image writer has been joined.");
+    }
+
+    return written;
+}
+
+std::string ImageWriter::suffixFor(const OutputFormat format) {
+    switch (format) {
+        case OutputFormat::Png8: return ".png";
+        case OutputFormat::Png16: return "_16u.png";
+        case OutputFormat::Tiff32F: return ".tiff";
+        case OutputFormat::Raw32F: return ".raw";
+    }
+
+    return "";
+}
+
+std::optional<OutputFormat> ImageWriter::formatFromName(const std::string& name) {
+    if (name == "png8") return OutputFormat::Png8;
+    if (name == "png16") return OutputFormat::Png16;
+    if (name == "tiff") return OutputFormat::Tiff32F;
+    if (name == "raw") return OutputFormat::Raw32F;
+
+    return std::nullopt;
+}
+
+void ImageWriter::writeNow(
+    const cv::Mat& image, const std::string& outputPath, const OutputFormat format
+) {
+    // Keep the extension of the temporary file, OpenCV picks the encoder from it
+    auto random = std::random_device();
+    auto tmpPath = fs::path(outputPath);
+    tmpPath.replace_filename(fmt::format(
+        "{}.tmp{:08x}{}", tmpPath.stem().string(), random(), tmpPath.extension().string()
+    ));
+
+    auto written = false;
+    if (format == OutputFormat::Raw32F) {
+        auto converted = cv::Mat();
+        image.convertTo(converted, CV_32F);
+
+        auto file = std::ofstream(tmpPath, std::ios::binary | std::ios::trunc);
+        MatIO::writeMat(file, converted);
+        file.close();
+        written = !file.fail();
+    }
+    else {
+        // Scaling and conversion run fused in one sweep, right before encoding
+        const auto depth = format == OutputFormat::Png8    ? CV_8U
+                           : format == OutputFormat::Png16 ? CV_16U
+                                                           : CV_32F;
+        written = cv::imwrite(tmpPath.string(), PostProcessing(image).normalizeTo(depth).getRef());
+    }
+
+    auto error = std::error_code();
+    if (written) fs::rename(tmpPath, outputPath, error);
+
+    if (!written || error) {
+        spdlog::error("Failed to save image as '{}'.", outputPath);
+        fs::remove(tmpPath, error);
+        throw std::runtime_error(fmt::format("Failed to save image as '{}'.", outputPath));
+    }
+
+    spdlog::info("Saved image as '{}'.", outputPath);
+}
@@ -0,0 +1,109 @@
+#include "Kernels.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+
+using std::string;
+using std::vector;
+
+namespace {
+
+/**
+ * @brief A compiled kernel variant and the CPU check guarding it.
+ */
+struct Variant {
+    Kernels kernels;
+    bool (*isSupported)();
+};
+
+// Ordered from the most to the least capable instruction set
+const Variant VARIANTS[] = {
+#ifdef CT_RAY_SIM_KERNEL_VARIANTS
+    { { "avx512",
+        kernels::avx512::traceRay,
+        kernels::avx512::backProjectRow,
+        kernels::avx512::fixedKernels },
+      [] {
+          return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") &&
+                 __builtin_cpu_supports("fma");
+      } },
+    { { "avx2",
+        kernels::avx2::traceRay,
+        kernels::avx2::backProjectRow,
+        kernels::avx2::fixedKernels },
+      [] { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); } },
+    { { "sse42",
+        kernels::sse42::traceRay,
+        kernels::sse42::backProjectRow,
+        kernels::sse42::fixedKernels },
+      [] { return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt"); } },
+#endif
+    { { "baseline",
+        kernels::baseline::traceRay,
+        kernels::baseline::backProjectRow,
+        kernels::baseline::fixedKernels },
+      [] { return true; } },
+};
+
+std::atomic<const Kernels*> activeKernels = nullptr;
+
+/**
+ * @brief Returns the variants supported by the running CPU, from the most to the least capable.
+ */
+vector<const Variant*> supportedVariants() {
+#ifdef CT_RAY_SIM_KERNEL_VARIANTS
+    __builtin_cpu_init();
+#endif
+
+    auto variants = vector<const Variant*>();
+    for (const auto& variant : VARIANTS)
+        if (variant.isSupported()) variants.push_back(&variant);
+
+    return variants;
+}
+
+}  // namespace
+
+const Kernels& Kernels::active() {
+    if (const auto* kernels = activeKernels.load(std::memory_order_acquire)) return *kernels;
+
+    select("auto");
+    return *activeKernels.load(std::memory_order_acquire);
+}
+
+bool Kernels::select(const string& isa) {
+    const auto variants = supportedVariants();
+    const auto variant = isa == "auto" ? variants.begin()
+                                       : std::ranges::find_if(variants, [&](const auto* variant) {
+                                             return variant->kernels.isa == isa;
+                                         });
+
+    if (variant == variants.end()) return false;
+
+    activeKernels.store(&(*variant)->kernels, std::memory_order_release);
+    spdlog::info("Using {} kernels.", (*variant)->kernels.isa);
+    return true;
+}
+
+Kernels::BackProjectRowFunction Kernels::backProjectRowFor(
+    const std::int32_t detectorSize,
+    const std::size_t width
+) const noexcept {
+    if (detectorSize > 0 && width == static_cast<std::size_t>(detectorSize))
+        for (const auto* entry = fixed(); entry->size != 0; ++entry)
+            if (entry->size == width) return entry->backProjectRow;
+
+    return backProjectRow;
+}
+
+vector<string> Kernels::supported() {
+    auto names = vector<string>();
+    std::ranges::transform(supportedVariants(), std::back_inserter(names), [](const auto* variant) {
+        return string(variant->kernels.isa);
+    });
+
+    return names;
+}
@@ -0,0 +1,198 @@
+// Compiled once per instruction set, see CT_DECLARE_KERNELS. Keep this file self-contained: an
+// inline function from a shared header would be emitted with the instruction set of the variant,
+// and the linker could pick that copy for the whole program.
+
+#include <cmath>
+
+#include "Kernels.hpp"
+
+#ifndef CT_KERNEL_ISA
+#define CT_KERNEL_ISA baseline
+#endif
+
+// The sizes the back-projection is additionally compiled for, set by CT_RAY_SIM_KERNEL_SIZES
+#ifndef CT_KERNEL_FIXED_SIZES
+#define CT_KERNEL_FIXED_SIZES 256, 512, 1024, 2048
+#endif
+
+using std::int32_t;
+using std::int64_t;
+using std::size_t;
+
+namespace kernels::CT_KERNEL_ISA {
+
+double traceRay(
+    const double* density,
+    const size_t stride,
+    const size_t size,
+    const double originX,
+    const double originY,
+    const double directionX,
+    const double directionY,
+    const double tStart,
+    const double tEnd,
+    const double deltaT
+) {
+    const auto limit = static_cast<int64_t>(size);
+    auto totalDensity = 0.0;
+
+    for (auto t = tStart; t < tEnd; t += deltaT) {
+        const auto x = static_cast<int64_t>(std::floor(originX + t * directionX));
+        const auto y = static_cast<int64_t>(std::floor(originY + t * directionY));
+
+        if (x >= 0 && x < limit && y >= 0 && y < limit)
+            totalDensity += density[y * stride + x] * deltaT;
+    }
+
+    return totalDensity;
+}
+
+namespace {
+
+/**
+ * @brief The back-projection for FixedSize detector cells and a row of FixedSize pixels, or for
+ * any sizes if FixedSize is 0. A fixed size gives the pixel loop a known trip count and the
+ * detector bounds checks a constant. The coverage is only counted if TrackCoverage is set.
+ */
+template <size_t FixedSize, bool TrackCoverage>
+void backProjectRowLoop(
+    const double* const* projections,
+    double* const* imageRows,
+    const size_t batchSize,
+    double* coverageRow,
+    const int32_t detectorSize,
+    const size_t width,
+    const double xStart,
+    const double xStep,
+    const double y,
+    const double sinAngle,
+    const double cosAngle
+) {
+    const auto cells = static_cast<int32_t>(FixedSize ? FixedSize : detectorSize);
+    const auto pixels = FixedSize ? FixedSize : width;
+    const auto center = static_cast<double>(cells) / 2.0;
+    const auto yRel = y - center;
+
+#if defined(__GNUC__)
+#pragma GCC unroll 4
+#endif
+    for (size_t x = 0; x < pixels; x++) {
+        const auto xRel = xStart + static_cast<double>(x) * xStep - center;
+        const auto detectorIndex = -xRel * sinAngle + yRel * cosAngle + center;
+
+        const auto index0 = static_cast<int32_t>(std::floor(detectorIndex));
+        const auto index1 = index0 + 1;
+        auto weight1 = detectorIndex - static_cast<double>(index0);
+        auto weight0 = 1.0 - weight1;
+
+        const auto inside0 = index0 >= 0 && index0 < cells;
+        const auto inside1 = index1 >= 0 && index1 < cells;
+
+        if (!inside0 && !inside1) continue;
+
+        // At the detector edges fall back to the nearest cell, so that the lookup below is a
+        // single weighted sum for the whole batch
+        if (!inside1) {
+            weight0 = 1.0;
+            weight1 = 0.0;
+        }
+        else if (!inside0) {
+            weight0 = 0.0;
+            weight1 = 1.0;
+        }
+
+        const auto safeIndex0 = index0 < 0 ? 0 : index0;
+        const auto safeIndex1 = index1 > cells - 1 ? cells - 1 : index1;
+
+        for (size_t item = 0; item < batchSize; ++item) {
+            const auto* projection = projections[item];
+            imageRows[item][x] +=
+                weight0 * projection[safeIndex0] + weight1 * projection[safeIndex1];
+        }
+
+        if constexpr (TrackCoverage) coverageRow[x] += 1.0;
+    }
+}
+
+/**
+ * @brief The back-projection for FixedSize, see backProjectRowLoop. Without a coverage row, the
+ * loop that skips the coverage is used.
+ */
+template <size_t FixedSize>
+void backProjectRowSized(
+    const double* const* projections,
+    double* const* imageRows,
+    const size_t batchSize,
+    double* coverageRow,
+    const int32_t detectorSize,
+    const size_t width,
+    const double xStart,
+    const double xStep,
+    const double y,
+    const double sinAngle,
+    const double cosAngle
+) {
+    const auto loop = coverageRow ? backProjectRowLoop<FixedSize, true>
+                                  : backProjectRowLoop<FixedSize, false>;
+
+    loop(
+        projections,
+        imageRows,
+        batchSize,
+        coverageRow,
+        detectorSize,
+        width,
+        xStart,
+        xStep,
+        y,
+        sinAngle,
+        cosAngle
+    );
+}
+
+/**
+ * @brief The table of the kernels specialized for Sizes, terminated by an entry of size 0.
+ */
+template <size_t... Sizes>
+struct FixedTable {
+    static constexpr Kernels::Fixed entries[] = {
+        { Sizes, backProjectRowSized<Sizes> }...,
+        { 0, nullptr },
+    };
+};
+
+}  // namespace
+
+void backProjectRow(
+    const double* const* projections,
+    double* const* imageRows,
+    const size_t batchSize,
+    double* coverageRow,
+    const int32_t detectorSize,
+    const size_t width,
+    const double xStart,
+    const double xStep,
+    const double y,
+    const double sinAngle,
+    const double cosAngle
+) {
+    backProjectRowSized<0>(
+        projections,
+        imageRows,
+        batchSize,
+        coverageRow,
+        detectorSize,
+        width,
+        xStart,
+        xStep,
+        y,
+        sinAngle,
+        cosAngle
+    );
+}
+
+const Kernels::Fixed* fixedKernels() {
+    return FixedTable<CT_KERNEL_FIXED_SIZES>::entries;
+}
+
+}  // namespace kernels::CT_KERNEL_ISA
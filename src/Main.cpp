@@ -3,19 +3,42 @@
  * @brief Entry point for the CT Ray Simulation application.
  */
 
+#include <fmt/core.h>
+#include <fmt/ranges.h>
 #include <spdlog/spdlog.h>
 
 #include <argparse/argparse.hpp>
+#include <algorithm>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <future>
 #include <memory>
+#include <optional>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
-#include "PostProcessing.hpp"
+#include "ContentHasher.hpp"
+#include "ImageWriter.hpp"
+#include "Kernels.hpp"
+#include "MatIO.hpp"
+#include "NoiseModel.hpp"
+#include "ReconstructionAccumulator.hpp"
+#include "ResultCache.hpp"
 #include "Simulation.hpp"
+#include "SimulationServer.hpp"
+#include "SinogramArchive.hpp"
+#include "TiledImage.hpp"
 
 using std::size_t;
 namespace fs = std::filesystem;
 
+// The number of tile pixels the export subcommand reads at once (64 MiB)
+constexpr size_t EXPORT_STRIP_PIXELS = size_t(1) << 24;
+
 /**
  * @class CLIArguments
  * @brief Structure to hold command-line arguments for the CT ray simulation.
@@ -25,6 +48,31 @@ class CLIArguments {
     std::string inputPath;
     std::string outputPath;
     size_t angles;
+    bool pipeline;
+    size_t queueDepth;
+    bool progressive;
+    AngleOrder order;
+    size_t snapshotEvery;
+    std::string spectrumPath;
+    size_t realizations;
+    NoiseType noise;
+    double photons;
+    double attenuation;
+    uint64_t seed;
+    std::optional<std::pair<size_t, size_t>> angleRange;
+    std::string cacheDir;
+    size_t cacheSize;
+    std::vector<OutputFormat> outputFormats;
+    size_t writerThreads;
+    std::string kernels;
+    size_t checkpointEvery;
+    bool resume;
+    std::optional<cv::Rect> roi;
+    double outputScale;
+    size_t pyramid;
+    bool outOfCore;
+    size_t memoryBudget;
+    std::optional<SinogramEncoding> sinogram;
 
     /**
      * @brief Parses command-line arguments and returns a CLIArguments instance.
@@ -35,7 +83,7 @@ class CLIArguments {
      *
      * @param argc Argument count.
      * @param argv Argument vector.
-     * @return Parsed CLIArguments with inputPath, outputPath, and angles.
+     * @return Parsed CLIArguments.
      */
     static CLIArguments parse(int argc, char* argv[]) {
         auto program = argparse::ArgumentParser("ct_ray_sim");
@@ -51,6 +99,579 @@ class CLIArguments {
             .default_value(32)
             .scan<'i', size_t>();
 
+        program.add_argument("--pipeline")
+            .help("Back-project each projection while the next angles are still being traced.")
+            .default_value(false)
+            .implicit_value(true);
+
+        program.add_argument("--queueDepth")
+            .help("Maximum number of traced projections waiting for back-projection (--pipeline).")
+            .default_value(size_t(8))
+            .scan<'i', size_t>();
+
+        program.add_argument("--progressive")
+            .help("Write partial reconstructions while the simulation is still running.")
+            .default_value(false)
+            .implicit_value(true);
+
+        program.add_argument("--order")
+            .help("Order in which angles are traced: sequential, bitreversed or golden.")
+            .default_value(std::string("golden"));
+
+        program.add_argument("--snapshotEvery")
+            .help("Number of angles between two partial reconstructions (--progressive).")
+            .default_value(size_t(16))
+            .scan<'i', size_t>();
+
+        program.add_argument("--spectrum")
+            .help("Path to a spectrum file. Enables the polychromatic simulation.")
+            .default_value(std::string(""));
+
+        program.add_argument("--realizations")
+            .help("Number of noise realizations to reconstruct from a single trace (0 disables).")
+            .default_value(size_t(0))
+            .scan<'i', size_t>();
+
+        program.add_argument("--noise")
+            .help("Noise distribution of the realizations: poisson or gaussian.")
+            .default_value(std::string("poisson"));
+
+        program.add_argument("--photons")
+            .help("Number of incident photons per ray (--realizations).")
+            .default_value(1e5)
+            .scan<'g', double>();
+
+        program.add_argument("--attenuation")
+            .help(
+                "Factor converting projection values to -ln(I / I0), or 0 to attenuate the "
+                "largest value to exp(-4) (--realizations)."
+            )
+            .default_value(0.0)
+            .scan<'g', double>();
+
+        program.add_argument("--seed")
+            .help("Seed of the noise generator (--realizations).")
+            .default_value(uint64_t(0))
+            .scan<'u', uint64_t>();
+
+        program.add_argument("--angleRange", "--angle-range")
+            .help(
+                "Only simulate the angles [start, end) and write them as a shard "
+                "(format start:end). Shards are combined with 'ct_ray_sim merge'."
+            )
+            .default_value(std::string(""));
+
+        program.add_argument("--cacheDir")
+            .help("Directory of a result cache shared between runs (disabled if empty).")
+            .default_value(std::string(""));
+
+        program.add_argument("--cacheSize")
+            .help("Maximum size of the result cache in MiB.")
+            .default_value(size_t(1024))
+            .scan<'i', size_t>();
+
+        program.add_argument("--sinogram")
+            .help("Encoding of the saved sinogram archive: none, float64, float32 or delta.")
+            .default_value(std::string("none"));
+
+        program.add_argument("--outputFormat")
+            .help("Comma-separated list of output formats: png8, png16, tiff or raw.")
+            .default_value(std::string("png8"));
+
+        program.add_argument("--writerThreads")
+            .help("Number of threads encoding and writing output images in the background.")
+            .default_value(size_t(2))
+            .scan<'i', size_t>();
+
+        program.add_argument("--kernels")
+            .help("Instruction set of the hot kernels: auto, avx512, avx2, sse42 or baseline.")
+            .default_value(std::string("auto"));
+
+        program.add_argument("--checkpointEvery")
+            .help("Number of angles between two checkpoints in the output directory (0 disables).")
+            .default_value(size_t(0))
+            .scan<'i', size_t>();
+
+        program.add_argument("--resume")
+            .help("Continue an interrupted simulation from its last checkpoint.")
+            .default_value(false)
+            .implicit_value(true);
+
+        program.add_argument("--roi")
+            .help("Only reconstruct the region x,y,width,height of the image (in input pixels).")
+            .default_value(std::string(""));
+
+        program.add_argument("--outputScale")
+            .help("Number of reconstructed pixels per input pixel, e.g. 0.25 for a quick preview.")
+            .default_value(1.0)
+            .scan<'g', double>();
+
+        program.add_argument("--pyramid")
+            .help("Number of coarse-to-fine reconstruction levels written one after another.")
+            .default_value(size_t(0))
+            .scan<'i', size_t>();
+
+        program.add_argument("--outOfCore")
+            .help("Stream the sinogram to disk and write the reconstruction as a tiled image.")
+            .default_value(false)
+            .implicit_value(true);
+
+        program.add_argument("--memoryBudget")
+            .help("Memory available for an out-of-core reconstruction in MiB.")
+            .default_value(size_t(1024))
+            .scan<'i', size_t>();
+
+        try {
+            program.parse_args(argc, argv);
+        }
+        catch (const std::exception& err) {
+            spdlog::error("Error parsing CLI arguments: {}", err.what());
+            std::exit(EXIT_FAILURE);
+        }
+
+        auto args = CLIArguments {
+            program.get<std::string>("--inputPath"),
+            program.get<std::string>("--outputPath"),
+            program.get<size_t>("--angles"),
+            program.get<bool>("--pipeline"),
+            program.get<size_t>("--queueDepth"),
+            program.get<bool>("--progressive"),
+            parseAngleOrder(program.get<std::string>("--order")),
+            program.get<size_t>("--snapshotEvery"),
+            program.get<std::string>("--spectrum"),
+            program.get<size_t>("--realizations"),
+            parseNoiseType(program.get<std::string>("--noise")),
+            program.get<double>("--photons"),
+            program.get<double>("--attenuation"),
+            program.get<uint64_t>("--seed"),
+            parseAngleRange(
+                program.get<std::string>("--angleRange"), program.get<size_t>("--angles")
+            ),
+            program.get<std::string>("--cacheDir"),
+            program.get<size_t>("--cacheSize"),
+            parseOutputFormats(program.get<std::string>("--outputFormat")),
+            program.get<size_t>("--writerThreads"),
+            program.get<std::string>("--kernels"),
+            program.get<size_t>("--checkpointEvery"),
+            program.get<bool>("--resume"),
+            parseRoi(program.get<std::string>("--roi")),
+            program.get<double>("--outputScale"),
+            program.get<size_t>("--pyramid"),
+            program.get<bool>("--outOfCore"),
+            program.get<size_t>("--memoryBudget"),
+            parseSinogramEncoding(program.get<std::string>("--sinogram"))
+        };
+
+        args.validate();
+        return args;
+    }
+
+  private:
+    /**
+     * @brief Rejects option values that are out of range and combinations of options that would
+     * silently be ignored. Terminates the program on invalid values.
+     */
+    void validate() const {
+        if (attenuation < 0.0) {
+            spdlog::error("The attenuation scale must not be negative, got {}.", attenuation);
+            std::exit(EXIT_FAILURE);
+        }
+
+        // Every mode runs its own kind of simulation, so at most one of them can be selected
+        auto modes = std::vector<std::string>();
+        if (angleRange) modes.emplace_back("--angleRange");
+        if (outOfCore) modes.emplace_back("--outOfCore");
+        if (realizations > 0) modes.emplace_back("--realizations");
+        if (checkpointEvery > 0 || resume) modes.emplace_back("--checkpointEvery/--resume");
+        if (pyramid > 1) modes.emplace_back("--pyramid");
+        if (progressive) modes.emplace_back("--progressive");
+        if (pipeline) modes.emplace_back("--pipeline");
+        if (sinogram) modes.emplace_back("--sinogram");
+
+        if (modes.size() > 1) {
+            spdlog::error("The options {} cannot be combined.", fmt::join(modes, ", "));
+            std::exit(EXIT_FAILURE);
+        }
+
+        // Shards and realizations are always reconstructed on the full image
+        if ((roi || outputScale != 1.0) && (angleRange || realizations > 0)) {
+            spdlog::error("--roi and --outputScale cannot be combined with {}.", modes.front());
+            std::exit(EXIT_FAILURE);
+        }
+
+        // The cache only holds the final images, so it cannot restore the other outputs of a mode
+        if (!cacheDir.empty() &&
+            (angleRange || outOfCore || realizations > 0 || pyramid > 1 || sinogram)) {
+            spdlog::error("--cacheDir cannot be combined with {}.", modes.front());
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    /**
+     * @brief Parses the name of an angle order. Terminates the program on unknown names.
+     *
+     * @param name The name of the angle order.
+     * @return The parsed AngleOrder.
+     */
+    static AngleOrder parseAngleOrder(const std::string& name) {
+        if (name == "sequential") return AngleOrder::Sequential;
+        if (name == "bitreversed") return AngleOrder::BitReversed;
+        if (name == "golden") return AngleOrder::GoldenAngle;
+
+        spdlog::error("Unknown angle order: {}", name);
+        std::exit(EXIT_FAILURE);
+    }
+
+    /**
+     * @brief Parses the encoding of the sinogram archive. Terminates the program on unknown
+     * names.
+     *
+     * @param name The name of the encoding, or "none" to write no archive.
+     * @return The parsed encoding, or std::nullopt for "none".
+     */
+    static std::optional<SinogramEncoding> parseSinogramEncoding(const std::string& name) {
+        if (name == "none") return std::nullopt;
+        if (name == "float64") return SinogramEncoding::Float64;
+        if (name == "float32") return SinogramEncoding::Float32;
+        if (name == "delta") return SinogramEncoding::Delta;
+
+        spdlog::error("Unknown sinogram encoding: {}", name);
+        std::exit(EXIT_FAILURE);
+    }
+
+    /**
+     * @brief Parses the name of a noise type. Terminates the program on unknown names.
+     *
+     * @param name The name of the noise type.
+     * @return The parsed NoiseType.
+     */
+    static NoiseType parseNoiseType(const std::string& name) {
+        if (name == "poisson") return NoiseType::Poisson;
+        if (name == "gaussian") return NoiseType::Gaussian;
+
+        spdlog::error("Unknown noise type: {}", name);
+        std::exit(EXIT_FAILURE);
+    }
+
+    /**
+     * @brief Parses an angle range of the form start:end. Terminates the program on malformed or
+     * empty ranges and on ranges exceeding the number of angles.
+     *
+     * @param range The angle range, or an empty string for the full scan.
+     * @param angles The total number of angles.
+     * @return The parsed range, or std::nullopt for the full scan.
+     */
+    static std::optional<std::pair<size_t, size_t>> parseAngleRange(
+        const std::string& range, const size_t angles
+    ) {
+        if (range.empty()) return std::nullopt;
+
+        auto begin = size_t(0);
+        auto end = size_t(0);
+        auto separator = char(0);
+        auto stream = std::istringstream(range);
+
+        if (!(stream >> begin >> separator >> end) || separator != ':' || !stream.eof() ||
+            begin >= end || end > angles) {
+            spdlog::error("Invalid angle range '{}' for {} angles.", range, angles);
+            std::exit(EXIT_FAILURE);
+        }
+
+        return std::make_pair(begin, end);
+    }
+
+  public:
+    // The following parsers are shared with the export subcommand
+
+    /**
+     * @brief Parses a region of interest of the form x,y,width,height. Terminates the program on
+     * malformed or empty regions.
+     *
+     * @param roi The region of interest, or an empty string for the whole image.
+     * @return The parsed region, or std::nullopt for the whole image.
+     */
+    static std::optional<cv::Rect> parseRoi(const std::string& roi) {
+        if (roi.empty()) return std::nullopt;
+
+        auto rect = cv::Rect();
+        auto separators = std::string(3, '\0');
+        auto stream = std::istringstream(roi);
+
+        if (!(stream >> rect.x >> separators[0] >> rect.y >> separators[1] >> rect.width >>
+              separators[2] >> rect.height) ||
+            separators != ",,," || !stream.eof() || rect.width <= 0 || rect.height <= 0) {
+            spdlog::error("Invalid region of interest '{}'.", roi);
+            std::exit(EXIT_FAILURE);
+        }
+
+        return rect;
+    }
+
+    /**
+     * @brief Parses a comma-separated list of output formats. Terminates the program on unknown
+     * names and on empty lists.
+     *
+     * @param names The comma-separated names of the output formats.
+     * @return The parsed output formats.
+     */
+    static std::vector<OutputFormat> parseOutputFormats(const std::string& names) {
+        auto formats = std::vector<OutputFormat>();
+        auto stream = std::istringstream(names);
+
+        for (auto name = std::string(); std::getline(stream, name, ',');) {
+            const auto format = ImageWriter::formatFromName(name);
+            if (!format) {
+                spdlog::error("Unknown output format: {}", name);
+                std::exit(EXIT_FAILURE);
+            }
+
+            formats.push_back(*format);
+        }
+
+        if (formats.empty()) {
+            spdlog::error("At least one output format is required.");
+            std::exit(EXIT_FAILURE);
+        }
+
+        return formats;
+    }
+};
+
+/**
+ * @class MergeArguments
+ * @brief Structure to hold command-line arguments for the merge subcommand.
+ */
+class MergeArguments {
+  public:
+    std::string outputPath;
+    std::vector<std::string> shardPaths;
+
+    /**
+     * @brief Parses the command-line arguments of the merge subcommand.
+     *
+     * @param argc Argument count, starting at the subcommand.
+     * @param argv Argument vector, starting at the subcommand.
+     * @return Parsed MergeArguments.
+     */
+    static MergeArguments parse(int argc, char* argv[]) {
+        auto program = argparse::ArgumentParser("ct_ray_sim merge");
+
+        program.add_argument("--outputPath")
+            .help("Path to the output directory where the merged result will be saved.")
+            .default_value(std::string("output"));
+
+        program.add_argument("shards").help("Shard files written with --angleRange.").remaining();
+
+        try {
+            program.parse_args(argc, argv);
+        }
+        catch (const std::exception& err) {
+            spdlog::error("Error parsing CLI arguments: {}", err.what());
+            std::exit(EXIT_FAILURE);
+        }
+
+        return { program.get<std::string>("--outputPath"),
+                 program.get<std::vector<std::string>>("shards") };
+    }
+};
+
+/**
+ * @class ReconstructArguments
+ * @brief Structure to hold command-line arguments for the reconstruct subcommand.
+ */
+class ReconstructArguments {
+  public:
+    std::string outputPath;
+    std::string sinogramPath;
+
+    /**
+     * @brief Parses the command-line arguments of the reconstruct subcommand.
+     *
+     * @param argc Argument count, starting at the subcommand.
+     * @param argv Argument vector, starting at the subcommand.
+     * @return Parsed ReconstructArguments.
+     */
+    static ReconstructArguments parse(int argc, char* argv[]) {
+        auto program = argparse::ArgumentParser("ct_ray_sim reconstruct");
+
+        program.add_argument("--outputPath")
+            .help("Path to the output directory where the reconstruction will be saved.")
+            .default_value(std::string("output"));
+
+        program.add_argument("sinogram").help("Sinogram archive written with --sinogram.");
+
+        try {
+            program.parse_args(argc, argv);
+        }
+        catch (const std::exception& err) {
+            spdlog::error("Error parsing CLI arguments: {}", err.what());
+            std::exit(EXIT_FAILURE);
+        }
+
+        return { program.get<std::string>("--outputPath"), program.get<std::string>("sinogram") };
+    }
+};
+
+/**
+ * @class ExportArguments
+ * @brief Structure to hold command-line arguments for the export subcommand.
+ */
+class ExportArguments {
+  public:
+    std::string outputPath;
+    std::string tilesPath;
+    std::optional<cv::Rect> roi;
+    size_t downsample;
+    std::vector<OutputFormat> outputFormats;
+
+    /**
+     * @brief Parses the command-line arguments of the export subcommand.
+     *
+     * @param argc Argument count, starting at the subcommand.
+     * @param argv Argument vector, starting at the subcommand.
+     * @return Parsed ExportArguments.
+     */
+    static ExportArguments parse(int argc, char* argv[]) {
+        auto program = argparse::ArgumentParser("ct_ray_sim export");
+
+        program.add_argument("--outputPath")
+            .help("Path to the output directory where the exported image will be saved.")
+            .default_value(std::string("output"));
+
+        program.add_argument("--roi")
+            .help("Region to export as x,y,width,height in image pixels (default: whole image).")
+            .default_value(std::string(""));
+
+        program.add_argument("--downsample")
+            .help("Factor to shrink the image by, averaging blocks of factor x factor pixels.")
+            .default_value(size_t(1))
+            .scan<'i', size_t>();
+
+        program.add_argument("--outputFormat")
+            .help("Comma-separated output formats: png8, png16, tiff and raw.")
+            .default_value(std::string("png8"));
+
+        program.add_argument("tiles").help("Tiled image written with --outOfCore.");
+
+        try {
+            program.parse_args(argc, argv);
+        }
+        catch (const std::exception& err) {
+            spdlog::error("Error parsing CLI arguments: {}", err.what());
+            std::exit(EXIT_FAILURE);
+        }
+
+        const auto downsample = program.get<size_t>("--downsample");
+        if (downsample == 0) {
+            spdlog::error("The downsampling factor must be positive.");
+            std::exit(EXIT_FAILURE);
+        }
+
+        return { program.get<std::string>("--outputPath"),
+                 program.get<std::string>("tiles"),
+                 CLIArguments::parseRoi(program.get<std::string>("--roi")),
+                 downsample,
+                 CLIArguments::parseOutputFormats(program.get<std::string>("--outputFormat")) };
+    }
+};
+
+/**
+ * @class CompareArguments
+ * @brief Structure to hold command-line arguments for the compare subcommand.
+ */
+class CompareArguments {
+  public:
+    std::string firstPath;
+    std::string secondPath;
+    double tolerance;
+
+    /**
+     * @brief Parses the command-line arguments of the compare subcommand.
+     *
+     * @param argc Argument count, starting at the subcommand.
+     * @param argv Argument vector, starting at the subcommand.
+     * @return Parsed CompareArguments.
+     */
+    static CompareArguments parse(int argc, char* argv[]) {
+        auto program = argparse::ArgumentParser("ct_ray_sim compare");
+
+        program.add_argument("--tolerance")
+            .help("Largest difference accepted, as a fraction of the first image's value range.")
+            .default_value(0.0)
+            .scan<'g', double>();
+
+        program.add_argument("first").help("Output image (raw or any format OpenCV reads).");
+        program.add_argument("second").help("Output image to compare with the first one.");
+
+        try {
+            program.parse_args(argc, argv);
+        }
+        catch (const std::exception& err) {
+            spdlog::error("Error parsing CLI arguments: {}", err.what());
+            std::exit(EXIT_FAILURE);
+        }
+
+        const auto tolerance = program.get<double>("--tolerance");
+        if (!(tolerance >= 0.0)) {
+            spdlog::error("The tolerance must not be negative.");
+            std::exit(EXIT_FAILURE);
+        }
+
+        return { program.get<std::string>("first"), program.get<std::string>("second"), tolerance };
+    }
+};
+
+/**
+ * @class ServeArguments
+ * @brief Structure to hold command-line arguments for the serve subcommand.
+ */
+class ServeArguments {
+  public:
+    std::string socketPath;
+    size_t workers;
+    size_t queueDepth;
+    size_t batch;
+    size_t cacheEntries;
+    std::string kernels;
+
+    /**
+     * @brief Parses the command-line arguments of the serve subcommand.
+     *
+     * @param argc Argument count, starting at the subcommand.
+     * @param argv Argument vector, starting at the subcommand.
+     * @return Parsed ServeArguments.
+     */
+    static ServeArguments parse(int argc, char* argv[]) {
+        auto program = argparse::ArgumentParser("ct_ray_sim serve");
+
+        program.add_argument("--socket")
+            .help("Path of the Unix domain socket to accept jobs on.")
+            .default_value(std::string("ct_ray_sim.sock"));
+
+        program.add_argument("--workers")
+            .help("Number of jobs simulated in parallel.")
+            .default_value(size_t(std::max(std::thread::hardware_concurrency(), 1U)))
+            .scan<'i', size_t>();
+
+        program.add_argument("--queueDepth")
+            .help("Maximum number of queued jobs before new requests are rejected as busy.")
+            .default_value(size_t(64))
+            .scan<'i', size_t>();
+
+        program.add_argument("--batch")
+            .help("Maximum number of queued jobs a worker takes at once.")
+            .default_value(size_t(8))
+            .scan<'i', size_t>();
+
+        program.add_argument("--cacheEntries")
+            .help("Number of input images kept loaded between jobs.")
+            .default_value(size_t(16))
+            .scan<'i', size_t>();
+
+        program.add_argument("--kernels")
+            .help("Instruction set of the hot kernels: auto, avx512, avx2, sse42 or baseline.")
+            .default_value(std::string("auto"));
+
         try {
             program.parse_args(argc, argv);
         }
@@ -59,9 +680,12 @@ class CLIArguments {
             std::exit(EXIT_FAILURE);
         }
 
-        return { program.get<std::string>("--inputPath"),
-                 program.get<std::string>("--outputPath"),
-                 program.get<size_t>("--angles") };
+        return { program.get<std::string>("--socket"),
+                 program.get<size_t>("--workers"),
+                 program.get<size_t>("--queueDepth"),
+                 program.get<size_t>("--batch"),
+                 program.get<size_t>("--cacheEntries"),
+                 program.get<std::string>("--kernels") };
     }
 };
 
@@ -78,6 +702,413 @@ void setupLogger() {
     }
 }
 
+/**
+ * @brief Creates the output directory if it does not exist yet.
+ *
+ * @param outputPath The path of the output directory.
+ */
+void ensureOutputDirectory(const std::string& outputPath) {
+    if (!fs::exists(outputPath)) {
+        if (!fs::create_directory(outputPath)) {
+            spdlog::error("Failed to create output directory: {}", outputPath);
+            throw std::runtime_error("Failed to create output directory.");
+        }
+        spdlog::info("Created output directory: {}", outputPath);
+    }
+}
+
+/**
+ * @brief Queues the projections and the reconstructed image of a result for writing in every
+ * requested format. The writes run in the background and overlap with further computation.
+ *
+ * @param writer The writer to queue the images on.
+ * @param res The result to write.
+ * @param outputPath The output directory.
+ * @param suffix The suffix appended to the file names.
+ * @param formats The formats to write the images in.
+ * @return The futures of the queued writes.
+ */
+std::vector<std::future<void>> saveResult(
+    ImageWriter& writer,
+    const SimulationResult& res,
+    const fs::path& outputPath,
+    const std::string& suffix,
+    const std::vector<OutputFormat>& formats
+) {
+    auto written = std::vector<std::future<void>>();
+    for (const auto format : formats) {
+        written.push_back(
+            writer.write(res.getProjections(), outputPath / ("projections" + suffix), format)
+        );
+        written.push_back(
+            writer.write(res.getImage(), outputPath / ("reconstructed_image" + suffix), format)
+        );
+    }
+
+    return written;
+}
+
+/**
+ * @brief Waits for queued writes. Failed writes have already been logged by the writer.
+ *
+ * @param written The futures of the writes.
+ * @return true if every write succeeded.
+ */
+bool waitForWrites(std::vector<std::future<void>>& written) {
+    auto succeeded = true;
+    for (auto& image : written) {
+        try {
+            image.get();
+        }
+        catch (const std::exception&) {
+            succeeded = false;
+        }
+    }
+
+    return succeeded;
+}
+
+/**
+ * @brief Builds the reconstruction grid selected by --roi and --outputScale. Terminates the
+ * program if the region exceeds the image or the scale is not positive.
+ *
+ * @param args The parsed command-line arguments.
+ * @param imageSize The size of the density map.
+ * @return The reconstruction grid.
+ */
+ReconstructionGrid makeReconstructionGrid(const CLIArguments& args, const size_t imageSize) {
+    const auto image = cv::Rect(0, 0, imageSize, imageSize);
+    const auto roi = args.roi.value_or(image);
+
+    if ((roi & image) != roi) {
+        spdlog::error(
+            "Region of interest {},{},{},{} exceeds the {}x{} image.",
+            roi.x,
+            roi.y,
+            roi.width,
+            roi.height,
+            imageSize,
+            imageSize
+        );
+        std::exit(EXIT_FAILURE);
+    }
+    if (!(args.outputScale > 0.0)) {
+        spdlog::error("Output scale must be positive, got {}.", args.outputScale);
+        std::exit(EXIT_FAILURE);
+    }
+
+    const auto grid = ReconstructionGrid::region(roi, args.outputScale);
+    spdlog::info("Reconstructing on a {}x{} grid.", grid.getWidth(), grid.getHeight());
+
+    return grid;
+}
+
+/**
+ * @brief Computes the key identifying the inputs of a simulation from the density data and every
+ * parameter that influences the result. Used by the result cache, to name checkpoints and to
+ * identify the shards of a scan.
+ *
+ * @param args The parsed command-line arguments.
+ * @param densityMap The density map of the simulation.
+ * @param grid The grid the image is reconstructed on.
+ * @return The input key.
+ */
+std::string computeInputKey(
+    const CLIArguments& args, const DensityMap& densityMap, const ReconstructionGrid& grid
+) {
+    auto hasher = ContentHasher();
+    hasher.update(std::string("ct_ray_sim result")).update(densityMap.getData());
+    hasher.update<uint64_t>(args.angles);
+    hasher.update(grid.getX()).update(grid.getY()).update(grid.getPixelSize());
+    hasher.update<uint64_t>(grid.getWidth()).update<uint64_t>(grid.getHeight());
+
+    if (!args.spectrumPath.empty()) {
+        auto spectrum = std::ifstream(args.spectrumPath, std::ios::binary);
+        hasher.update(std::string(std::istreambuf_iterator<char>(spectrum), {}));
+    }
+
+    return hasher.hexDigest();
+}
+
+/**
+ * @brief Runs the simulation in the mode selected by the command-line arguments.
+ *
+ * @param args The parsed command-line arguments.
+ * @param sim The simulation to run.
+ * @param writer The writer used for the partial reconstructions.
+ * @param written Receives the futures of the partial reconstructions' writes.
+ * @param checkpointPath The path of the checkpoint file (--checkpointEvery, --resume).
+ * @param inputKey The hash of the inputs, recorded in the checkpoints.
+ * @param grid The grid to reconstruct the image on.
+ * @return The result of the simulation.
+ */
+SimulationResult simulate(
+    const CLIArguments& args,
+    const Simulation& sim,
+    ImageWriter& writer,
+    std::vector<std::future<void>>& written,
+    const fs::path& checkpointPath,
+    const std::string& inputKey,
+    const ReconstructionGrid& grid
+) {
+    if (args.checkpointEvery > 0 || args.resume) {
+        return sim.simulateCTCheckpointed(
+            args.angles,
+            args.checkpointEvery,
+            checkpointPath.string(),
+            inputKey,
+            args.resume,
+            grid
+        );
+    }
+
+    if (args.pyramid > 1) {
+        return sim.simulateCTPyramid(
+            args.angles, grid, args.pyramid, [&](const cv::Mat& image, size_t level) {
+                const auto levelPath =
+                    fs::path(args.outputPath) / fmt::format("reconstructed_image_level{}", level);
+                for (const auto format : args.outputFormats)
+                    written.push_back(writer.write(image, levelPath, format));
+            }
+        );
+    }
+
+    if (args.progressive) {
+        const auto snapshotPath = fs::path(args.outputPath) / "reconstructed_image";
+        return sim.simulateCTProgressive(
+            args.angles,
+            args.order,
+            args.snapshotEvery,
+            [&](const cv::Mat& image, size_t) {
+                // Snapshots are written synchronously, so they never overtake each other
+                auto snapshot = writer.write(image, snapshotPath, args.outputFormats.front());
+                snapshot.wait();
+                written.push_back(std::move(snapshot));
+            },
+            grid
+        );
+    }
+
+    if (args.pipeline) return sim.simulateCTPipelined(args.angles, args.queueDepth, grid);
+
+    if (args.sinogram) {
+        const auto sinogramPath = fs::path(args.outputPath) / "sinogram.ctsino";
+        return sim.simulateCT(args.angles, grid, sinogramPath.string(), *args.sinogram);
+    }
+
+    return sim.simulateCT(args.angles, grid);
+}
+
+/**
+ * @brief Merges simulation shards into the result of the full scan and saves it.
+ *
+ * @param args The parsed command-line arguments of the merge subcommand.
+ * @return int Exit status code.
+ */
+int32_t merge(const MergeArguments& args) {
+    auto shards = std::vector<SimulationShard>();
+    for (const auto& shardPath : args.shardPaths)
+        shards.push_back(SimulationShard::load(shardPath));
+
+    const auto res = SimulationShard::merge(shards);
+
+    ensureOutputDirectory(args.outputPath);
+
+    auto writer = ImageWriter(1);
+    auto written = saveResult(writer, res, args.outputPath, "", { OutputFormat::Png8 });
+    writer.join();
+    if (!waitForWrites(written)) return EXIT_FAILURE;
+
+    spdlog::info("Merged {} shards successfully.", shards.size());
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Reconstructs the image of a sinogram archive and saves it, without tracing again.
+ *
+ * @param args The parsed command-line arguments of the reconstruct subcommand.
+ * @return int Exit status code.
+ */
+int32_t reconstruct(const ReconstructArguments& args) {
+    const auto sinogram = SinogramArchive(args.sinogramPath);
+
+    // The projections are read in place from the mapped archive
+    auto accumulator = ReconstructionAccumulator(sinogram.getDetectorSize());
+    for (size_t i = 0; i < sinogram.getNumAngles(); ++i)
+        accumulator.accumulate(sinogram.projection(i), sinogram.angle(i));
+
+    ensureOutputDirectory(args.outputPath);
+
+    auto writer = ImageWriter(1);
+    auto written = std::vector<std::future<void>>();
+    written.push_back(writer.write(
+        accumulator.getNormalizedImage(),
+        fs::path(args.outputPath) / "reconstructed_image",
+        OutputFormat::Png8
+    ));
+    writer.join();
+    if (!waitForWrites(written)) return EXIT_FAILURE;
+
+    spdlog::info("Reconstructed {} projections successfully.", sinogram.getNumAngles());
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Exports a region of a tiled image as reconstructed_image in the requested formats. The
+ * region is read and downsampled strip by strip, so only the downsampled image and one strip are
+ * held in memory at a time.
+ *
+ * @param args The parsed command-line arguments of the export subcommand.
+ * @return int Exit status code.
+ */
+int32_t exportTiles(const ExportArguments& args) {
+    const auto size = TiledImage::readSize(args.tilesPath);
+    const auto image = cv::Rect(0, 0, size.width, size.height);
+    const auto region = args.roi.value_or(image);
+    if ((region & image) != region) {
+        spdlog::error(
+            "Region {}x{}+{}+{} exceeds the {}x{} image.",
+            region.width,
+            region.height,
+            region.x,
+            region.y,
+            image.width,
+            image.height
+        );
+        return EXIT_FAILURE;
+    }
+
+    // Incomplete blocks at the right and bottom edges are dropped
+    const auto factor = static_cast<int>(args.downsample);
+    auto exported = cv::Mat(region.height / factor, region.width / factor, CV_32F);
+    if (exported.empty()) {
+        spdlog::error("The region is smaller than the downsampling factor {}.", factor);
+        return EXIT_FAILURE;
+    }
+
+    // Every strip covers whole blocks, so the strips are downsampled independently
+    const auto blockPixels = static_cast<size_t>(exported.cols) * args.downsample * args.downsample;
+    const auto stripRows = static_cast<int>(std::max(EXPORT_STRIP_PIXELS / blockPixels, size_t(1)));
+    for (auto row = 0; row < exported.rows; row += stripRows) {
+        auto strip = exported.rowRange(row, std::min(row + stripRows, exported.rows));
+        const auto source = TiledImage::readRegion(
+            args.tilesPath,
+            cv::Rect(
+                region.x, region.y + row * factor, strip.cols * factor, strip.rows * factor
+            )
+        );
+
+        auto downsampled = cv::Mat();
+        cv::resize(source, downsampled, strip.size(), 0.0, 0.0, cv::INTER_AREA);
+        downsampled.copyTo(strip);
+    }
+
+    ensureOutputDirectory(args.outputPath);
+
+    auto writer = ImageWriter(1);
+    auto written = std::vector<std::future<void>>();
+    for (const auto format : args.outputFormats)
+        written.push_back(
+            writer.write(exported, fs::path(args.outputPath) / "reconstructed_image", format)
+        );
+    writer.join();
+    if (!waitForWrites(written)) return EXIT_FAILURE;
+
+    spdlog::info("Exported {}x{} image successfully.", exported.cols, exported.rows);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Loads an output image for comparison, either a raw MatIO file or a grayscale image in
+ * any format OpenCV reads, as CV_64F.
+ *
+ * @param imagePath The path of the image.
+ * @return The image, or an empty matrix if it cannot be read.
+ */
+cv::Mat loadOutputImage(const std::string& imagePath) {
+    auto image = cv::Mat();
+
+    if (fs::path(imagePath).extension() == ".raw") {
+        auto file = std::ifstream(imagePath, std::ios::binary);
+        try {
+            if (file) image = MatIO::readMat(file);
+        }
+        catch (const std::runtime_error&) {
+            image = cv::Mat();
+        }
+    }
+    else image = cv::imread(imagePath, cv::IMREAD_ANYDEPTH);
+
+    if (!image.empty()) image.convertTo(image, CV_64F);
+    return image;
+}
+
+/**
+ * @brief Compares two output images element-wise and fails if they differ by more than the
+ * tolerance, relative to the value range of the first image. Outputs of different modes that
+ * agree up to floating-point rounding are compared this way.
+ *
+ * @param args The parsed command-line arguments of the compare subcommand.
+ * @return int Exit status code.
+ */
+int32_t compare(const CompareArguments& args) {
+    const auto first = loadOutputImage(args.firstPath);
+    const auto second = loadOutputImage(args.secondPath);
+    if (first.empty() || second.empty()) {
+        spdlog::error("Failed to read '{}' or '{}'.", args.firstPath, args.secondPath);
+        return EXIT_FAILURE;
+    }
+
+    if (first.size() != second.size()) {
+        spdlog::error("'{}' and '{}' differ in size.", args.firstPath, args.secondPath);
+        return EXIT_FAILURE;
+    }
+
+    auto minValue = 0.0;
+    auto maxValue = 0.0;
+    cv::minMaxLoc(first, &minValue, &maxValue);
+    const auto difference = cv::norm(first, second, cv::NORM_INF);
+    const auto allowed = args.tolerance * (maxValue - minValue);
+
+    if (!(difference <= allowed)) {
+        spdlog::error(
+            "'{}' and '{}' differ by up to {} (allowed: {}).",
+            args.firstPath,
+            args.secondPath,
+            difference,
+            allowed
+        );
+        return EXIT_FAILURE;
+    }
+
+    spdlog::info("Images agree (largest difference: {}).", difference);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Serves simulation jobs over a Unix domain socket until a shutdown request arrives.
+ *
+ * @param args The parsed command-line arguments of the serve subcommand.
+ * @return int Exit status code.
+ */
+int32_t serve(const ServeArguments& args) {
+    if (!Kernels::select(args.kernels)) {
+        spdlog::error(
+            "Kernel variant '{}' is not available on this CPU (supported: {}).",
+            args.kernels,
+            fmt::join(Kernels::supported(), ", ")
+        );
+        return EXIT_FAILURE;
+    }
+
+    auto server = SimulationServer(
+        args.socketPath, args.workers, args.queueDepth, args.batch, args.cacheEntries
+    );
+    server.run();
+
+    return EXIT_SUCCESS;
+}
+
 /**
  * @brief The main entry point of the CT ray simulation program.
  *
@@ -91,6 +1122,22 @@ void setupLogger() {
  */
 int32_t main(int32_t argc, char* argv[]) {
     setupLogger();
+
+    if (argc > 1 && std::string_view(argv[1]) == "merge")
+        return merge(MergeArguments::parse(argc - 1, argv + 1));
+
+    if (argc > 1 && std::string_view(argv[1]) == "reconstruct")
+        return reconstruct(ReconstructArguments::parse(argc - 1, argv + 1));
+
+    if (argc > 1 && std::string_view(argv[1]) == "export")
+        return exportTiles(ExportArguments::parse(argc - 1, argv + 1));
+
+    if (argc > 1 && std::string_view(argv[1]) == "compare")
+        return compare(CompareArguments::parse(argc - 1, argv + 1));
+
+    if (argc > 1 && std::string_view(argv[1]) == "serve")
+        return serve(ServeArguments::parse(argc - 1, argv + 1));
+
     const auto args = CLIArguments::parse(argc, argv);
 
     spdlog::info(
@@ -100,27 +1147,97 @@ int32_t main(int32_t argc, char* argv[]) {
         args.angles
     );
 
+    if (!Kernels::select(args.kernels)) {
+        spdlog::error(
+            "Kernel variant '{}' is not available on this CPU (supported: {}).",
+            args.kernels,
+            fmt::join(Kernels::supported(), ", ")
+        );
+        return EXIT_FAILURE;
+    }
+
     const auto densityMap = DensityMap(args.inputPath);
-    const auto sim = Simulation(densityMap);
-    const auto res = sim.simulateCT(args.angles);
 
-    if (!fs::exists(args.outputPath)) {
-        if (!fs::create_directory(args.outputPath)) {
-            spdlog::error("Failed to create output directory: {}", args.outputPath);
-            throw std::runtime_error("Failed to create output directory.");
+    // A malformed spectrum file is reported by Spectrum
+    auto spectrum = std::optional<Spectrum>();
+    try {
+        if (!args.spectrumPath.empty()) spectrum.emplace(args.spectrumPath);
+    }
+    catch (const std::runtime_error&) {
+        return EXIT_FAILURE;
+    }
+
+    const auto sim = spectrum ? Simulation(densityMap, *spectrum) : Simulation(densityMap);
+
+    ensureOutputDirectory(args.outputPath);
+
+    auto writer = ImageWriter(args.writerThreads);
+    auto written = std::vector<std::future<void>>();
+    const auto grid = makeReconstructionGrid(args, densityMap.getSize());
+    const auto inputKey = computeInputKey(args, densityMap, grid);
+
+    // Checkpoints are named by the input key, so a resume never continues a different scan
+    const auto checkpointPath =
+        args.checkpointEvery > 0 || args.resume
+            ? fs::path(args.outputPath) / fmt::format("checkpoint_{}.bin", inputKey)
+            : fs::path();
+
+    if (args.angleRange) {
+        const auto [angleBegin, angleEnd] = *args.angleRange;
+        const auto shardPath =
+            fs::path(args.outputPath) / fmt::format("shard_{}_{}.bin", angleBegin, angleEnd);
+
+        sim.simulateShard(args.angles, angleBegin, angleEnd, inputKey).save(shardPath);
+    }
+    else if (args.outOfCore) {
+        sim.simulateCTOutOfCore(
+            args.angles,
+            grid,
+            fs::path(args.outputPath) / "sinogram.ctsino",
+            fs::path(args.outputPath) / "reconstructed_image.tiles",
+            args.memoryBudget * 1024 * 1024
+        );
+    }
+    else if (args.realizations > 0) {
+        const auto noiseModel =
+            NoiseModel(args.noise, args.photons, args.attenuation, args.seed);
+        const auto results =
+            sim.simulateCTNoiseRealizations(args.angles, noiseModel, args.realizations);
+
+        for (size_t k = 0; k < results.size(); ++k) {
+            const auto suffix = fmt::format("_{:04}", k);
+            for (auto& image :
+                 saveResult(writer, results[k], args.outputPath, suffix, args.outputFormats))
+                written.push_back(std::move(image));
         }
-        spdlog::info("Created output directory: {}", args.outputPath);
     }
+    else if (!args.cacheDir.empty()) {
+        const auto cache = ResultCache(args.cacheDir, args.cacheSize * 1024 * 1024);
 
-    PostProcessing(res.getProjections())
-        .normalize()
-        .to8U()
-        .saveImage(fs::path(args.outputPath) / "projections.png");
+        auto res = cache.load(inputKey);
+        if (!res) {
+            res = simulate(args, sim, writer, written, checkpointPath, inputKey, grid);
+            cache.store(inputKey, *res);
+        }
+
+        for (auto& image : saveResult(writer, *res, args.outputPath, "", args.outputFormats))
+            written.push_back(std::move(image));
+    }
+    else {
+        const auto res = simulate(args, sim, writer, written, checkpointPath, inputKey, grid);
+        for (auto& image : saveResult(writer, res, args.outputPath, "", args.outputFormats))
+            written.push_back(std::move(image));
+    }
+
+    writer.join();
 
-    PostProcessing(res.getImage())
-        .normalize()
-        .to8U()
-        .saveImage(fs::path(args.outputPath) / "reconstructed_image.png");
+    // The checkpoint is only needed until all outputs are written
+    if (!waitForWrites(written)) {
+        if (!checkpointPath.empty())
+            spdlog::error("Not all outputs were written, keeping '{}'.", checkpointPath.string());
+        return EXIT_FAILURE;
+    }
+    if (!checkpointPath.empty()) fs::remove(checkpointPath);
 
     spdlog::info("CT simulation completed successfully.");
     return EXIT_SUCCESS;
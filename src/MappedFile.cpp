@@ -0,0 +1,121 @@
+#include "MappedFile.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+    : m_data(nullptr),
+      m_size(0)
+#ifdef _WIN32
+      ,
+      m_mapping(nullptr)
+#endif
+{
+    auto error = std::error_code();
+    const auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        spdlog::error("Failed to open '{}' for mapping: {}", path, error.message());
+        throw std::runtime_error("Failed to map file.");
+    }
+    if (size == 0) return;
+
+#ifdef _WIN32
+    const auto file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    auto* mapping = file == INVALID_HANDLE_VALUE
+                        ? nullptr
+                        : CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+
+    auto* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data) {
+        if (mapping) CloseHandle(mapping);
+        spdlog::error("Failed to map '{}'.", path);
+        throw std::runtime_error("Failed to map file.");
+    }
+
+    m_mapping = mapping;
+#else
+    const auto file = ::open(path.c_str(), O_RDONLY);
+    auto* data = file < 0 ? MAP_FAILED : ::mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    if (file >= 0) ::close(file);
+
+    if (data == MAP_FAILED) {
+        spdlog::error("Failed to map '{}'.", path);
+        throw std::runtime_error("Failed to map file.");
+    }
+#endif
+
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = static_cast<std::size_t>(size);
+    spdlog::debug("Mapped '{}' ({} bytes).", path, m_size);
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+      ,
+      m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+const unsigned char* MappedFile::data() const noexcept {
+    return m_data;
+}
+
+std::size_t MappedFile::size() const noexcept {
+    return m_size;
+}
+
+void MappedFile::unmap() noexcept {
+    if (!m_data) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mapping);
+    m_mapping = nullptr;
+#else
+    ::munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
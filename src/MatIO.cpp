@@ -0,0 +1,59 @@
+#include "MatIO.hpp"
+
+#include <fmt/core.h>
+
+void MatIO::writeHeader(std::ostream& stream, const std::string& magic, uint32_t version) {
+    stream.write(magic.data(), static_cast<std::streamsize>(magic.size()));
+    writeValue(stream, version);
+}
+
+void MatIO::readHeader(std::istream& stream, const std::string& magic, uint32_t version) {
+    auto actual = std::string(magic.size(), '\0');
+    if (!stream.read(actual.data(), static_cast<std::streamsize>(actual.size())) || actual != magic)
+        throw std::runtime_error(fmt::format("Not a {} file.", magic));
+
+    const auto actualVersion = readValue<uint32_t>(stream);
+    if (actualVersion != version) {
+        throw std::runtime_error(
+            fmt::format("Unsupported {} version {} (expected {}).", magic, actualVersion, version)
+        );
+    }
+}
+
+void MatIO::writeString(std::ostream& stream, const std::string& value) {
+    writeValue<uint64_t>(stream, value.size());
+    stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+std::string MatIO::readString(std::istream& stream) {
+    auto value = std::string(readValue<uint64_t>(stream), '\0');
+    if (!stream.read(value.data(), static_cast<std::streamsize>(value.size())))
+        throw std::runtime_error("Unexpected end of file.");
+    return value;
+}
+
+void MatIO::writeMat(std::ostream& stream, const cv::Mat& mat) {
+    writeValue<int32_t>(stream, mat.rows);
+    writeValue<int32_t>(stream, mat.cols);
+    writeValue<int32_t>(stream, mat.type());
+
+    const auto rowBytes = static_cast<std::streamsize>(mat.cols * mat.elemSize());
+    for (int32_t row = 0; row < mat.rows; ++row)
+        stream.write(reinterpret_cast<const char*>(mat.ptr(row)), rowBytes);
+}
+
+cv::Mat MatIO::readMat(std::istream& stream) {
+    const auto rows = readValue<int32_t>(stream);
+    const auto cols = readValue<int32_t>(stream);
+    const auto type = readValue<int32_t>(stream);
+
+    if (rows < 0 || cols < 0)
+        throw std::runtime_error(fmt::format("Invalid matrix size {}x{}.", rows, cols));
+
+    auto mat = cv::Mat(rows, cols, type);
+    const auto bytes = static_cast<std::streamsize>(mat.total() * mat.elemSize());
+    if (!stream.read(reinterpret_cast<char*>(mat.data), bytes))
+        throw std::runtime_error("Unexpected end of file.");
+
+    return mat;
+}
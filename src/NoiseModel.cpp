@@ -0,0 +1,110 @@
+#include "NoiseModel.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cmath>
+#include <numbers>
+
+using std::uint64_t;
+
+namespace {
+
+// The attenuation -ln(I / I0) of the largest projection value if the scale is derived
+constexpr double DERIVED_MAX_ATTENUATION = 4.0;
+
+/**
+ * @brief The SplitMix64 finalizer, a bijective 64-bit mixing function.
+ */
+constexpr uint64_t mix64(uint64_t x) noexcept {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+}  // namespace
+
+NoiseModel::NoiseModel(
+    const NoiseType type,
+    const double incidentPhotons,
+    const double attenuationScale,
+    const std::uint64_t seed
+)
+    : m_type(type),
+      m_incidentPhotons(incidentPhotons),
+      m_attenuationScale(attenuationScale),
+      m_seed(seed) { }
+
+cv::Mat NoiseModel::apply(const cv::Mat& projections, const std::uint64_t realization) const {
+    spdlog::debug("Generating noise realization {}.", realization);
+
+    auto noisy = cv::Mat(projections.rows, projections.cols, CV_64F, cv::Scalar(0));
+    const auto attenuationScale = attenuationScaleFor(projections);
+    const auto cols = static_cast<uint64_t>(projections.cols);
+
+    cv::parallel_for_(cv::Range(0, projections.rows), [&](const cv::Range& rows) {
+        for (auto row = rows.start; row < rows.end; ++row) {
+            const auto* in = projections.ptr<double>(row);
+            auto* out = noisy.ptr<double>(row);
+
+            for (uint64_t col = 0; col < cols; ++col) {
+                const auto position = static_cast<uint64_t>(row) * cols + col;
+                const auto expected = m_incidentPhotons * std::exp(-attenuationScale * in[col]);
+
+                auto counts = 0.0;
+                if (m_type == NoiseType::Poisson && expected < 64.0) {
+                    // Inversion by sequential search, needs a single uniform
+                    const auto u = uniform(realization, position, 0);
+                    auto probability = std::exp(-expected);
+                    auto cumulative = probability;
+                    while (u > cumulative && probability > 0.0) {
+                        counts += 1.0;
+                        probability *= expected / counts;
+                        cumulative += probability;
+                    }
+                }
+                else {
+                    // Box-Muller transform
+                    const auto u0 = uniform(realization, position, 0);
+                    const auto u1 = uniform(realization, position, 1);
+                    const auto z = std::sqrt(-2.0 * std::log(u0)) *
+                                   std::cos(2.0 * std::numbers::pi * u1);
+
+                    counts = expected + std::sqrt(expected) * z;
+                    if (m_type == NoiseType::Poisson) counts = std::round(counts);
+                }
+
+                // Clamp to a single photon so that starved rays stay finite
+                counts = std::max(counts, 1.0);
+                out[col] = -std::log(counts / m_incidentPhotons) / attenuationScale;
+            }
+        }
+    });
+
+    return noisy;
+}
+
+double NoiseModel::attenuationScaleFor(const cv::Mat& projections) const {
+    if (m_attenuationScale > 0.0) return m_attenuationScale;
+
+    auto maxValue = 0.0;
+    cv::minMaxLoc(projections, nullptr, &maxValue);
+
+    // An empty object attenuates nothing, any scale leaves it noiseless
+    if (!(maxValue > 0.0)) return 1.0;
+
+    const auto attenuationScale = DERIVED_MAX_ATTENUATION / maxValue;
+    spdlog::debug(
+        "Derived attenuation scale {:.6g} from a maximum of {:.4f}.", attenuationScale, maxValue
+    );
+    return attenuationScale;
+}
+
+double NoiseModel::uniform(
+    const std::uint64_t realization, const std::uint64_t position, const std::uint64_t draw
+) const noexcept {
+    const auto key = mix64(m_seed ^ mix64(realization + 0x9e3779b97f4a7c15ULL));
+    const auto bits = mix64(key ^ mix64((position << 2 | draw) + 0x632be59bd9b4e019ULL));
+
+    // Use the upper 53 bits and offset by half a step to stay strictly inside (0, 1)
+    return (static_cast<double>(bits >> 11) + 0.5) * 0x1.0p-53;
+}
@@ -2,6 +2,8 @@
 
 #include <spdlog/spdlog.h>
 
+#include <limits>
+
 PostProcessing::PostProcessing(const cv::Mat& image) : m_image(image) { }
 
 PostProcessing::PostProcessing(cv::Mat&& image) : m_image(std::move(image)) { }
@@ -11,6 +13,25 @@ PostProcessing& PostProcessing::normalize() {
     return *this;
 }
 
+PostProcessing& PostProcessing::normalizeTo(int depth) {
+    auto minValue = 0.0;
+    auto maxValue = 0.0;
+    cv::minMaxIdx(m_image, &minValue, &maxValue);
+
+    const auto targetMax = depth == CV_8U ? 255.0 : depth == CV_16U ? 65535.0 : 1.0;
+    const auto range = maxValue - minValue;
+
+    // Mirrors cv::normalize, which maps a constant image to 0
+    const auto scale = range > std::numeric_limits<double>::epsilon() ? targetMax / range : 0.0;
+
+    // Convert into a new buffer, the image data may be shared with the caller
+    auto converted = cv::Mat();
+    m_image.convertTo(converted, depth, scale, -minValue * scale);
+    m_image = std::move(converted);
+
+    return *this;
+}
+
 PostProcessing& PostProcessing::to8U() {
     m_image.convertTo(m_image, CV_8U, 255.0);
     return *this;
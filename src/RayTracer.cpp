@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <ranges>
 
+#include "Kernels.hpp"
+
 using namespace glm;
 
 using std::numeric_limits;
@@ -76,6 +78,69 @@ double RayTracer::traceRay(const Ray& ray) const {
         length
     );
 
+    auto tStart = 0.0;
+    auto tEnd = 0.0;
+    if (!intersectScanField(ray, tStart, tEnd)) return 0.0;
+
+    const auto& density = m_densityMap.getData();
+    const auto deltaT = 0.5;
+    spdlog::trace("using deltaT={:.4f} for integration.", deltaT);
+
+    const auto totalDensity = Kernels::active().traceRay(
+        density.ptr<double>(),
+        density.step1(),
+        m_densityMap.getSize(),
+        origin.x,
+        origin.y,
+        direction.x,
+        direction.y,
+        tStart,
+        tEnd,
+        deltaT
+    );
+
+    spdlog::trace("Final Total Density: {:.4f}", totalDensity);
+    return totalDensity;
+}
+
+vector<double> RayTracer::traceRayPerMaterial(
+    const Ray& ray, const vector<double>& materialBounds
+) const {
+    auto pathLengths = vector<double>(materialBounds.size(), 0.0);
+
+    auto tStart = 0.0;
+    auto tEnd = 0.0;
+    if (!intersectScanField(ray, tStart, tEnd)) return pathLengths;
+
+    const auto origin = ray.getOrigin();
+    const auto direction = ray.getDirection();
+    const auto imageSize = m_densityMap.getSize();
+    const auto deltaT = 0.5;
+
+    for (auto t = tStart; t < tEnd; t += deltaT) {
+        const auto p = origin + t * direction;
+
+        const auto x = static_cast<size_t>(std::floor(p.x));
+        const auto y = static_cast<size_t>(std::floor(p.y));
+
+        if (x < imageSize && y < imageSize) {
+            const auto density = m_densityMap.getDensity(x, y);
+            const auto bound = std::ranges::lower_bound(materialBounds, density);
+            const auto material = std::min(
+                static_cast<size_t>(bound - materialBounds.begin()), materialBounds.size() - 1
+            );
+
+            pathLengths[material] += density * deltaT;
+        }
+    }
+
+    return pathLengths;
+}
+
+bool RayTracer::intersectScanField(const Ray& ray, double& tStart, double& tEnd) const {
+    const auto origin = ray.getOrigin();
+    const auto direction = ray.getDirection();
+
     const auto imageSize = m_densityMap.getSize();
     const auto scanField = cv::Rect(0, 0, imageSize, imageSize);
 
@@ -92,8 +157,8 @@ double RayTracer::traceRay(const Ray& ray) const {
         tExit = min(tExit, tExitX);
     }
     else if (origin.x < scanField.x || origin.x > scanField.width) {
-        spdlog::trace("Ray is parallel to x-axis and outside image bounds. Returning 0.0");
-        return 0.0;
+        spdlog::trace("Ray is parallel to x-axis and outside image bounds.");
+        return false;
     }
 
     if (direction.y != 0.0) {
@@ -106,51 +171,21 @@ double RayTracer::traceRay(const Ray& ray) const {
         tExit = min(tExit, tExitY);
     }
     else if (origin.y < scanField.y || origin.y > scanField.height) {
-        spdlog::trace("Ray is parallel to y-axis and outside image bounds. Returning 0.0");
-        return 0.0;
+        spdlog::trace("Ray is parallel to y-axis and outside image bounds.");
+        return false;
     }
 
     if (tExit < tEntry || tExit < 0.0) {
-        spdlog::trace("No valid intersection with image boundaries. Returning 0.0");
-        return 0.0;
+        spdlog::trace("No valid intersection with image boundaries.");
+        return false;
     }
 
-    const auto tStart = max(tEntry, 0.0);
-    const auto tEnd = tExit;
+    tStart = max(tEntry, 0.0);
+    tEnd = tExit;
 
     spdlog::trace(
         "Integrating from tStart={:.4f} to tEnd={:.4f} across image boundaries.", tStart, tEnd
     );
 
-    const auto deltaT = 0.5;
-    spdlog::trace("using deltaT={:.4f} for integration.", deltaT);
-
-    double totalDensity = 0.0;
-
-    for (auto t = tStart; t < tEnd; t += deltaT) {
-        const auto p = origin + t * direction;
-
-        const auto x = static_cast<size_t>(std::floor(p.x));
-        const auto y = static_cast<size_t>(std::floor(p.y));
-
-        // if (x >= 0 && x < imageSize && y >= 0 && y < imageSize) {
-        if (x < imageSize && y < imageSize) {
-            const auto density = m_densityMap.getDensity(x, y);
-            totalDensity += density * deltaT;
-            spdlog::trace(
-                "Accumulated density: {:.4f} * {:.4f} = {:.4f}, Total Density: {:.4f}",
-                density,
-                deltaT,
-                density * deltaT,
-                totalDensity
-            );
-        }
-
-        else {
-            spdlog::trace("Point ({}, {}) is out of bounds. Skipping.", x, y);
-        }
-    }
-
-    spdlog::trace("Final Total Density: {:.4f}", totalDensity);
-    return totalDensity;
+    return true;
 }
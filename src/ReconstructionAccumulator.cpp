@@ -0,0 +1,230 @@
+#include "ReconstructionAccumulator.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <glm/glm.hpp>
+#include <limits>
+#include <stdexcept>
+
+#include "Kernels.hpp"
+#include "MatIO.hpp"
+
+using namespace glm;
+
+using std::numeric_limits;
+using std::size_t;
+using std::vector;
+
+ReconstructionAccumulator::ReconstructionAccumulator(std::size_t imageSize, std::size_t batchSize)
+    : ReconstructionAccumulator(ReconstructionGrid::full(imageSize), imageSize, batchSize) { }
+
+ReconstructionAccumulator::ReconstructionAccumulator(
+    const ReconstructionGrid& grid,
+    std::size_t detectorSize,
+    std::size_t batchSize,
+    Normalization normalization
+)
+    : m_imageSize(detectorSize),
+      m_grid(grid),
+      m_normalization(normalization),
+      m_images(),
+      m_coverage(),
+      m_min(batchSize, numeric_limits<double>::infinity()),
+      m_max(batchSize, -numeric_limits<double>::infinity()),
+      m_numProjections(0) {
+    m_images.reserve(batchSize);
+    for (size_t item = 0; item < batchSize; ++item)
+        m_images.emplace_back(grid.getHeight(), grid.getWidth(), CV_64F, cv::Scalar(0));
+
+    if (normalization == Normalization::Deferred)
+        m_coverage = cv::Mat(grid.getHeight(), grid.getWidth(), CV_64F, cv::Scalar(0));
+}
+
+void ReconstructionAccumulator::accumulate(const cv::Mat& projection, const double phi) {
+    accumulate(vector<cv::Mat>{ projection }, phi);
+}
+
+void ReconstructionAccumulator::accumulate(const vector<cv::Mat>& projections, const double phi) {
+    spdlog::debug("Accumulating projection for angle: {:.2f} degrees", degrees(phi));
+
+    const auto batchSize = m_images.size();
+    if (projections.size() != batchSize) {
+        spdlog::error("Expected {} projections per angle, got {}.", batchSize, projections.size());
+        throw std::invalid_argument("Projection batch does not match the accumulator.");
+    }
+
+    // A plain sum needs neither the value range nor the coverage
+    const auto trackNormalization = m_normalization == Normalization::Deferred;
+
+    for (size_t item = 0; item < batchSize && trackNormalization; ++item) {
+        auto projectionMin = 0.0;
+        auto projectionMax = 0.0;
+        cv::minMaxLoc(projections[item], &projectionMin, &projectionMax);
+        m_min[item] = std::min(m_min[item], projectionMin);
+        m_max[item] = std::max(m_max[item], projectionMax);
+    }
+
+    // The kernel reads every projection as a plain array of doubles, so copy column views of a
+    // sinogram and convert other depths
+    auto contiguous = vector<cv::Mat>();
+    auto projectionData = vector<const double*>();
+    auto imageRows = vector<double*>(batchSize);
+    for (const auto& projection : projections) {
+        if (projection.isContinuous() && projection.type() == CV_64F) {
+            contiguous.push_back(projection);
+        }
+        else {
+            contiguous.emplace_back();
+            projection.convertTo(contiguous.back(), CV_64F);
+        }
+        projectionData.push_back(contiguous.back().ptr<double>());
+    }
+
+    // Full-width rows of the common image sizes use the kernel specialized for their size
+    const auto detectorSize = static_cast<int32_t>(m_imageSize);
+    const auto backProjectRow =
+        Kernels::active().backProjectRowFor(detectorSize, m_grid.getWidth());
+    const auto cosAngle = cos(phi);
+    const auto sinAngle = sin(phi);
+
+    for (size_t row = 0; row < m_grid.getHeight(); row++) {
+        for (size_t item = 0; item < batchSize; ++item)
+            imageRows[item] = m_images[item].ptr<double>(row);
+
+        backProjectRow(
+            projectionData.data(),
+            imageRows.data(),
+            batchSize,
+            trackNormalization ? m_coverage.ptr<double>(row) : nullptr,  // nullptr skips counting
+            detectorSize,
+            m_grid.getWidth(),
+            m_grid.columnCenter(0),
+            m_grid.getPixelSize(),
+            m_grid.rowCenter(row),
+            sinAngle,
+            cosAngle
+        );
+    }
+
+    ++m_numProjections;
+}
+
+const cv::Mat& ReconstructionAccumulator::getImage(std::size_t item) const noexcept {
+    return m_images[item];
+}
+
+cv::Mat ReconstructionAccumulator::getNormalizedImage(std::size_t item) const {
+    if (m_normalization != Normalization::Deferred) {
+        spdlog::error("Cannot normalize an accumulator that only sums its projections.");
+        throw std::logic_error("Accumulator does not track the normalization.");
+    }
+
+    // Normalizing p to (p - min) / (max - min) before back-projection is, up to rounding, the same
+    // as subtracting min once per contributing projection afterwards and scaling the sum, since
+    // back-projection is linear. Mirrors cv::normalize, which maps a constant input to 0.
+    const auto range = m_max[item] - m_min[item];
+    if (m_numProjections == 0 || !(range > numeric_limits<double>::epsilon()))
+        return cv::Mat(m_grid.getHeight(), m_grid.getWidth(), CV_64F, cv::Scalar(0));
+
+    auto image = cv::Mat();
+    cv::scaleAdd(m_coverage, -m_min[item], m_images[item], image);
+    image.convertTo(image, CV_64F, 1.0 / range);
+
+    return image;
+}
+
+size_t ReconstructionAccumulator::getNumProjections() const noexcept {
+    return m_numProjections;
+}
+
+const ReconstructionGrid& ReconstructionAccumulator::getGrid() const noexcept {
+    return m_grid;
+}
+
+void ReconstructionAccumulator::merge(const ReconstructionAccumulator& other) {
+    if (other.m_imageSize != m_imageSize || other.m_images.size() != m_images.size() ||
+        other.m_grid != m_grid || other.m_normalization != m_normalization) {
+        spdlog::error(
+            "Cannot merge accumulator of size {} (batch {}) into size {} (batch {}) or across "
+            "reconstruction grids and normalizations.",
+            other.m_imageSize,
+            other.m_images.size(),
+            m_imageSize,
+            m_images.size()
+        );
+        throw std::invalid_argument("Accumulators do not match.");
+    }
+
+    for (size_t item = 0; item < m_images.size(); ++item) {
+        m_images[item] += other.m_images[item];
+        m_min[item] = std::min(m_min[item], other.m_min[item]);
+        m_max[item] = std::max(m_max[item], other.m_max[item]);
+    }
+
+    if (m_normalization == Normalization::Deferred) m_coverage += other.m_coverage;
+    m_numProjections += other.m_numProjections;
+}
+
+ReconstructionAccumulator ReconstructionAccumulator::clone() const {
+    auto copy = ReconstructionAccumulator(*this);
+    for (auto& image : copy.m_images) image = image.clone();
+    copy.m_coverage = m_coverage.clone();
+
+    return copy;
+}
+
+void ReconstructionAccumulator::write(std::ostream& stream) const {
+    if (m_normalization != Normalization::Deferred) {
+        spdlog::error("Cannot save an accumulator that only sums its projections.");
+        throw std::logic_error("Accumulator does not track the normalization.");
+    }
+
+    MatIO::writeValue<uint64_t>(stream, m_imageSize);
+    MatIO::writeValue(stream, m_grid.getX());
+    MatIO::writeValue(stream, m_grid.getY());
+    MatIO::writeValue<uint64_t>(stream, m_grid.getWidth());
+    MatIO::writeValue<uint64_t>(stream, m_grid.getHeight());
+    MatIO::writeValue(stream, m_grid.getPixelSize());
+    MatIO::writeValue<uint64_t>(stream, m_images.size());
+    MatIO::writeValue<uint64_t>(stream, m_numProjections);
+
+    for (size_t item = 0; item < m_images.size(); ++item) {
+        MatIO::writeValue(stream, m_min[item]);
+        MatIO::writeValue(stream, m_max[item]);
+        MatIO::writeMat(stream, m_images[item]);
+    }
+
+    MatIO::writeMat(stream, m_coverage);
+}
+
+ReconstructionAccumulator ReconstructionAccumulator::read(std::istream& stream) {
+    const auto imageSize = MatIO::readValue<uint64_t>(stream);
+    const auto x = MatIO::readValue<double>(stream);
+    const auto y = MatIO::readValue<double>(stream);
+    const auto width = MatIO::readValue<uint64_t>(stream);
+    const auto height = MatIO::readValue<uint64_t>(stream);
+    const auto pixelSize = MatIO::readValue<double>(stream);
+    const auto grid = ReconstructionGrid(x, y, width, height, pixelSize);
+    const auto batchSize = MatIO::readValue<uint64_t>(stream);
+
+    auto accumulator = ReconstructionAccumulator(grid, imageSize, 0);
+    accumulator.m_numProjections = MatIO::readValue<uint64_t>(stream);
+
+    for (size_t item = 0; item < batchSize; ++item) {
+        accumulator.m_min.push_back(MatIO::readValue<double>(stream));
+        accumulator.m_max.push_back(MatIO::readValue<double>(stream));
+        accumulator.m_images.push_back(MatIO::readMat(stream));
+    }
+
+    accumulator.m_coverage = MatIO::readMat(stream);
+
+    const auto expectedSize = cv::Size(width, height);
+    for (const auto& image : accumulator.m_images) {
+        if (image.size() != expectedSize || image.type() != CV_64F)
+            throw std::runtime_error("Corrupt reconstruction accumulator.");
+    }
+    if (accumulator.m_coverage.size() != expectedSize || accumulator.m_coverage.type() != CV_64F)
+        throw std::runtime_error("Corrupt reconstruction accumulator.");
+
+    return accumulator;
+}
@@ -0,0 +1,86 @@
+#include "ReconstructionGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using std::size_t;
+
+ReconstructionGrid::ReconstructionGrid(
+    const double x,
+    const double y,
+    const std::size_t width,
+    const std::size_t height,
+    const double pixelSize
+)
+    : m_x(x),
+      m_y(y),
+      m_width(width),
+      m_height(height),
+      m_pixelSize(pixelSize) { }
+
+ReconstructionGrid ReconstructionGrid::full(const std::size_t imageSize) {
+    return ReconstructionGrid(0.0, 0.0, imageSize, imageSize, 1.0);
+}
+
+ReconstructionGrid ReconstructionGrid::region(const cv::Rect& roi, const double outputScale) {
+    const auto width = std::max(std::lround(roi.width * outputScale), 1L);
+    const auto height = std::max(std::lround(roi.height * outputScale), 1L);
+
+    return ReconstructionGrid(
+        roi.x,
+        roi.y,
+        static_cast<size_t>(width),
+        static_cast<size_t>(height),
+        static_cast<double>(roi.width) / static_cast<double>(width)
+    );
+}
+
+ReconstructionGrid ReconstructionGrid::coarsened(const std::size_t factor) const {
+    return ReconstructionGrid(
+        m_x,
+        m_y,
+        (m_width + factor - 1) / factor,
+        (m_height + factor - 1) / factor,
+        m_pixelSize * static_cast<double>(factor)
+    );
+}
+
+ReconstructionGrid ReconstructionGrid::subgrid(const cv::Rect& pixels) const {
+    return ReconstructionGrid(
+        m_x + pixels.x * m_pixelSize,
+        m_y + pixels.y * m_pixelSize,
+        pixels.width,
+        pixels.height,
+        m_pixelSize
+    );
+}
+
+double ReconstructionGrid::columnCenter(const std::size_t column) const noexcept {
+    // Pixel centers of the density map sit at integer coordinates, so the full grid at native
+    // resolution yields exactly the column index
+    return m_x + (static_cast<double>(column) + 0.5) * m_pixelSize - 0.5;
+}
+
+double ReconstructionGrid::rowCenter(const std::size_t row) const noexcept {
+    return m_y + (static_cast<double>(row) + 0.5) * m_pixelSize - 0.5;
+}
+
+double ReconstructionGrid::getX() const noexcept {
+    return m_x;
+}
+
+double ReconstructionGrid::getY() const noexcept {
+    return m_y;
+}
+
+size_t ReconstructionGrid::getWidth() const noexcept {
+    return m_width;
+}
+
+size_t ReconstructionGrid::getHeight() const noexcept {
+    return m_height;
+}
+
+double ReconstructionGrid::getPixelSize() const noexcept {
+    return m_pixelSize;
+}
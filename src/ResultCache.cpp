@@ -0,0 +1,134 @@
+#include "ResultCache.hpp"
+
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "MatIO.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const auto CACHE_MAGIC = std::string("CTCACHE");
+constexpr uint32_t CACHE_VERSION = 1;
+const auto CACHE_EXTENSION = std::string(".bin");
+
+}  // namespace
+
+ResultCache::ResultCache(const std::string& cacheDir, std::uintmax_t maxBytes)
+    : m_cacheDir(cacheDir),
+      m_maxBytes(maxBytes) {
+    fs::create_directories(m_cacheDir);
+    spdlog::debug("Using result cache at '{}' (max {} bytes).", cacheDir, maxBytes);
+}
+
+std::optional<SimulationResult> ResultCache::load(const std::string& key) const {
+    const auto path = entryPath(key);
+
+    // The entry may be evicted by another process at any time, so a failed open is a plain miss
+    auto file = std::ifstream(path, std::ios::binary);
+    if (!file) {
+        spdlog::info("Result cache miss for {}.", key);
+        return std::nullopt;
+    }
+
+    try {
+        MatIO::readHeader(file, CACHE_MAGIC, CACHE_VERSION);
+
+        const auto keySize = MatIO::readValue<uint32_t>(file);
+        if (keySize != key.size()) throw std::runtime_error("Key mismatch.");
+
+        auto storedKey = std::string(keySize, '\0');
+        file.read(storedKey.data(), static_cast<std::streamsize>(storedKey.size()));
+        if (storedKey != key) throw std::runtime_error("Key mismatch.");
+
+        auto image = MatIO::readMat(file);
+        auto projections = MatIO::readMat(file);
+
+        auto error = std::error_code();
+        fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+
+        spdlog::info("Result cache hit for {}.", key);
+        return SimulationResult(std::move(image), std::move(projections));
+    }
+    catch (const std::exception& err) {
+        spdlog::warn("Ignoring corrupt result cache entry '{}': {}", path.string(), err.what());
+        return std::nullopt;
+    }
+}
+
+void ResultCache::store(const std::string& key, const SimulationResult& result) const {
+    const auto path = entryPath(key);
+    auto random = std::random_device();
+    const auto suffix = (static_cast<uint64_t>(random()) << 32) | random();
+    const auto tmpPath = fs::path(path.string() + fmt::format(".tmp.{:016x}", suffix));
+
+    try {
+        {
+            auto file = std::ofstream(tmpPath, std::ios::binary | std::ios::trunc);
+            MatIO::writeHeader(file, CACHE_MAGIC, CACHE_VERSION);
+            MatIO::writeValue<uint32_t>(file, key.size());
+            file.write(key.data(), static_cast<std::streamsize>(key.size()));
+            MatIO::writeMat(file, result.getImage());
+            MatIO::writeMat(file, result.getProjections());
+
+            if (!file.flush()) throw std::runtime_error("Failed to write entry.");
+        }
+
+        fs::rename(tmpPath, path);
+        spdlog::info("Stored result in cache as {}.", key);
+    }
+    catch (const std::exception& err) {
+        spdlog::warn("Failed to store result in cache: {}", err.what());
+
+        auto error = std::error_code();
+        fs::remove(tmpPath, error);
+        return;
+    }
+
+    evict();
+}
+
+fs::path ResultCache::entryPath(const std::string& key) const {
+    return m_cacheDir / (key + CACHE_EXTENSION);
+}
+
+void ResultCache::evict() const {
+    struct Entry {
+        fs::path path;
+        fs::file_time_type lastUse;
+        std::uintmax_t size;
+    };
+
+    auto entries = std::vector<Entry>();
+    auto totalBytes = std::uintmax_t(0);
+    auto error = std::error_code();
+
+    for (const auto& file : fs::directory_iterator(m_cacheDir, error)) {
+        if (file.path().extension() != CACHE_EXTENSION) continue;
+
+        const auto size = file.file_size(error);
+        if (error) continue;
+        const auto lastUse = file.last_write_time(error);
+        if (error) continue;
+
+        entries.push_back({ file.path(), lastUse, size });
+        totalBytes += size;
+    }
+
+    if (totalBytes <= m_maxBytes) return;
+
+    std::ranges::sort(entries, {}, &Entry::lastUse);
+    for (const auto& entry : entries) {
+        if (totalBytes <= m_maxBytes) break;
+
+        // Another process may have evicted the same entry already
+        if (fs::remove(entry.path, error)) spdlog::debug("Evicted '{}'.", entry.path.string());
+        totalBytes -= entry.size;
+    }
+}
@@ -2,6 +2,19 @@
 
 #include <spdlog/spdlog.h>
 
+#include <bit>
+#include <exception>
+#include <filesystem>
+#include <numeric>
+#include <thread>
+#include <utility>
+
+#include "BoundedQueue.hpp"
+#include "ReconstructionAccumulator.hpp"
+#include "SimulationCheckpoint.hpp"
+#include "SinogramArchive.hpp"
+#include "TiledImage.hpp"
+
 using namespace glm;
 using std::size_t;
 
@@ -13,26 +26,375 @@ Simulation::Simulation(DensityMap&& densityMap)
     : m_densityMap(std::move(densityMap)),
       m_rayTracer(m_densityMap) { }
 
+Simulation::Simulation(const DensityMap& densityMap, const Spectrum& spectrum)
+    : m_densityMap(densityMap),
+      m_rayTracer(m_densityMap),
+      m_spectrum(spectrum) { }
+
 SimulationResult Simulation::simulateCT(const std::size_t numAngles) const {
+    return simulateCT(numAngles, ReconstructionGrid::full(m_densityMap.getSize()));
+}
+
+SimulationResult Simulation::simulateCT(
+    const std::size_t numAngles, const ReconstructionGrid& grid
+) const {
+    spdlog::info("Starting CT simulation with {} angles.", numAngles);
+
+    const auto imageSize = m_densityMap.getSize();
+    auto projections = cv::Mat(imageSize, numAngles, CV_64F, cv::Scalar(0));
+
+    for (size_t i = 0; i < numAngles; ++i)
+        simulateProjectionForAngle(angleForIndex(i, numAngles)).copyTo(projections.col(i));
+
+    filterProjections(projections);
+
+    auto image = backProject(projections, grid);
+    return SimulationResult(image, projections);
+}
+
+SimulationResult Simulation::simulateCT(
+    const std::size_t numAngles,
+    const ReconstructionGrid& grid,
+    const std::string& sinogramPath,
+    const SinogramEncoding encoding
+) const {
     spdlog::info("Starting CT simulation with {} angles.", numAngles);
 
     const auto imageSize = m_densityMap.getSize();
     auto projections = cv::Mat(imageSize, numAngles, CV_64F, cv::Scalar(0));
+    auto sinogram = SinogramWriter(sinogramPath, imageSize, numAngles, encoding);
 
     for (size_t i = 0; i < numAngles; ++i) {
-        const auto phi = radians(static_cast<double>(i) * (360.0 / numAngles));
-        simulateProjectionForAngle(phi).copyTo(projections.col(i));
+        const auto phi = angleForIndex(i, numAngles);
+        const auto projection = simulateProjectionForAngle(phi);
+
+        // Archive the projection before filtering, so it can be reconstructed separately
+        sinogram.append(projection, phi);
+        projection.copyTo(projections.col(i));
     }
 
+    sinogram.finish();
     filterProjections(projections);
 
-    auto image = backProject(projections);
+    auto image = backProject(projections, grid);
     return SimulationResult(image, projections);
 }
 
+SimulationResult Simulation::simulateCTPyramid(
+    const std::size_t numAngles,
+    const ReconstructionGrid& grid,
+    const std::size_t numLevels,
+    const LevelCallback& onLevel
+) const {
+    spdlog::info("Starting CT simulation with {} angles and {} levels.", numAngles, numLevels);
+
+    const auto imageSize = m_densityMap.getSize();
+    auto projections = cv::Mat(imageSize, numAngles, CV_64F, cv::Scalar(0));
+
+    for (size_t i = 0; i < numAngles; ++i)
+        simulateProjectionForAngle(angleForIndex(i, numAngles)).copyTo(projections.col(i));
+
+    filterProjections(projections);
+
+    for (auto level = numLevels; level-- > 1;) {
+        const auto levelGrid = grid.coarsened(size_t(1) << level);
+        spdlog::info(
+            "Reconstructing level {} ({}x{}).", level, levelGrid.getWidth(), levelGrid.getHeight()
+        );
+        onLevel(backProject(projections, levelGrid), level);
+    }
+
+    auto image = backProject(projections, grid);
+    return SimulationResult(std::move(image), std::move(projections));
+}
+
+void Simulation::simulateCTOutOfCore(
+    const std::size_t numAngles,
+    const ReconstructionGrid& grid,
+    const std::string& sinogramPath,
+    const std::string& imagePath,
+    const std::size_t memoryBudget
+) const {
+    spdlog::info("Starting out-of-core CT simulation with {} angles.", numAngles);
+
+    const auto imageSize = m_densityMap.getSize();
+
+    {
+        auto writer = SinogramWriter(sinogramPath, imageSize, numAngles, SinogramEncoding::Float64);
+        for (size_t i = 0; i < numAngles; ++i) {
+            const auto phi = angleForIndex(i, numAngles);
+            writer.append(simulateProjectionForAngle(phi), phi);
+        }
+
+        writer.finish();
+    }
+
+    const auto sinogram = SinogramArchive(sinogramPath);
+
+    // Per tile pixel: the accumulated image and coverage, the normalized tile and the padded
+    // 32-bit copy written to the file
+    const auto bytesPerPixel = 3 * sizeof(double) + sizeof(float);
+    const auto maxTileSize = std::max(grid.getWidth(), grid.getHeight());
+    const auto budgetTileSize = static_cast<size_t>(
+        std::sqrt(static_cast<double>(memoryBudget) / static_cast<double>(bytesPerPixel))
+    );
+    const auto tileSize = std::min(std::max(budgetTileSize / 16 * 16, size_t(16)), maxTileSize);
+
+    auto image = TiledImage(imagePath, grid.getWidth(), grid.getHeight(), tileSize);
+
+    for (size_t tileY = 0; tileY < image.getTilesY(); ++tileY) {
+        for (size_t tileX = 0; tileX < image.getTilesX(); ++tileX) {
+            const auto region = image.tileRegion(tileX, tileY);
+            auto accumulator = ReconstructionAccumulator(grid.subgrid(region), imageSize);
+
+            // The projections are read in place from the mapped archive
+            for (size_t i = 0; i < numAngles; ++i)
+                accumulator.accumulate(sinogram.projection(i), sinogram.angle(i));
+
+            image.writeTile(tileX, tileY, accumulator.getNormalizedImage());
+        }
+
+        spdlog::info("Reconstructed tile row {}/{}.", tileY + 1, image.getTilesY());
+    }
+
+    image.finish();
+}
+
+SimulationResult Simulation::simulateCTPipelined(
+    const std::size_t numAngles, const std::size_t queueDepth, const ReconstructionGrid& grid
+) const {
+    spdlog::info(
+        "Starting pipelined CT simulation with {} angles (queue depth {}).", numAngles, queueDepth
+    );
+
+    const auto imageSize = m_densityMap.getSize();
+    auto projections = cv::Mat(imageSize, numAngles, CV_64F, cv::Scalar(0));
+    auto accumulator = ReconstructionAccumulator(grid, imageSize);
+    auto queue = BoundedQueue<std::pair<size_t, cv::Mat>>(queueDepth);
+    auto tracerError = std::exception_ptr();
+
+    auto tracer = std::thread([&] {
+        try {
+            for (size_t i = 0; i < numAngles; ++i) {
+                if (!queue.push({ i, simulateProjectionForAngle(angleForIndex(i, numAngles)) }))
+                    break;
+            }
+        }
+        catch (...) {
+            tracerError = std::current_exception();
+        }
+        queue.close();
+    });
+
+    try {
+        while (auto item = queue.pop()) {
+            const auto& [i, projection] = *item;
+            accumulator.accumulate(projection, angleForIndex(i, numAngles));
+            projection.copyTo(projections.col(i));
+        }
+    }
+    catch (...) {
+        queue.close();
+        tracer.join();
+        throw;
+    }
+
+    tracer.join();
+    if (tracerError) std::rethrow_exception(tracerError);
+
+    filterProjections(projections);
+
+    return SimulationResult(accumulator.getNormalizedImage(), std::move(projections));
+}
+
+SimulationResult Simulation::simulateCTProgressive(
+    const std::size_t numAngles,
+    const AngleOrder order,
+    const std::size_t snapshotInterval,
+    const SnapshotCallback& onSnapshot,
+    const ReconstructionGrid& grid
+) const {
+    spdlog::info(
+        "Starting progressive CT simulation with {} angles (snapshot every {} angles).",
+        numAngles,
+        snapshotInterval
+    );
+
+    const auto imageSize = m_densityMap.getSize();
+    auto projections = cv::Mat(imageSize, numAngles, CV_64F, cv::Scalar(0));
+    auto accumulator = ReconstructionAccumulator(grid, imageSize);
+
+    for (const auto i : orderAngles(numAngles, order)) {
+        const auto phi = angleForIndex(i, numAngles);
+        const auto projection = simulateProjectionForAngle(phi);
+
+        accumulator.accumulate(projection, phi);
+        projection.copyTo(projections.col(i));
+
+        const auto numDone = accumulator.getNumProjections();
+        if (snapshotInterval > 0 && numDone < numAngles && numDone % snapshotInterval == 0) {
+            spdlog::info("Snapshot after {}/{} angles.", numDone, numAngles);
+            onSnapshot(accumulator.getNormalizedImage(), numDone);
+        }
+    }
+
+    filterProjections(projections);
+
+    return SimulationResult(accumulator.getNormalizedImage(), std::move(projections));
+}
+
+std::vector<SimulationResult> Simulation::simulateCTNoiseRealizations(
+    const std::size_t numAngles,
+    const NoiseModel& noiseModel,
+    const std::size_t numRealizations
+) const {
+    spdlog::info(
+        "Starting CT simulation with {} angles and {} noise realizations.",
+        numAngles,
+        numRealizations
+    );
+
+    const auto imageSize = m_densityMap.getSize();
+    auto projections = cv::Mat(imageSize, numAngles, CV_64F, cv::Scalar(0));
+
+    for (size_t i = 0; i < numAngles; ++i)
+        simulateProjectionForAngle(angleForIndex(i, numAngles)).copyTo(projections.col(i));
+
+    auto noisyProjections = std::vector<cv::Mat>();
+    noisyProjections.reserve(numRealizations);
+    for (size_t k = 0; k < numRealizations; ++k)
+        noisyProjections.push_back(noiseModel.apply(projections, k));
+
+    spdlog::info("Reconstructing {} noise realizations as one batch.", numRealizations);
+    auto accumulator = ReconstructionAccumulator(imageSize, numRealizations);
+    auto columns = std::vector<cv::Mat>(numRealizations);
+
+    for (size_t i = 0; i < numAngles; ++i) {
+        for (size_t k = 0; k < numRealizations; ++k) columns[k] = noisyProjections[k].col(i);
+        accumulator.accumulate(columns, angleForIndex(i, numAngles));
+    }
+
+    auto results = std::vector<SimulationResult>();
+    results.reserve(numRealizations);
+    for (size_t k = 0; k < numRealizations; ++k) {
+        filterProjections(noisyProjections[k]);
+        results.emplace_back(accumulator.getNormalizedImage(k), std::move(noisyProjections[k]));
+    }
+
+    return results;
+}
+
+SimulationShard Simulation::simulateShard(
+    const std::size_t numAngles,
+    const std::size_t angleBegin,
+    const std::size_t angleEnd,
+    const std::string& inputKey
+) const {
+    spdlog::info(
+        "Starting CT simulation of angles [{}, {}) out of {}.", angleBegin, angleEnd, numAngles
+    );
+
+    const auto imageSize = m_densityMap.getSize();
+    auto projections = cv::Mat(imageSize, angleEnd - angleBegin, CV_64F, cv::Scalar(0));
+    auto accumulator = ReconstructionAccumulator(imageSize);
+
+    for (size_t i = angleBegin; i < angleEnd; ++i) {
+        const auto phi = angleForIndex(i, numAngles);
+        const auto projection = simulateProjectionForAngle(phi);
+
+        accumulator.accumulate(projection, phi);
+        projection.copyTo(projections.col(i - angleBegin));
+    }
+
+    return SimulationShard(
+        inputKey, numAngles, angleBegin, angleEnd, std::move(projections), std::move(accumulator)
+    );
+}
+
+SimulationResult Simulation::simulateCTCheckpointed(
+    const std::size_t numAngles,
+    const std::size_t checkpointInterval,
+    const std::string& checkpointPath,
+    const std::string& inputKey,
+    const bool resume,
+    const ReconstructionGrid& grid
+) const {
+    spdlog::info(
+        "Starting CT simulation with {} angles (checkpoint every {} angles).",
+        numAngles,
+        checkpointInterval
+    );
+
+    const auto imageSize = m_densityMap.getSize();
+    auto projections = cv::Mat(imageSize, numAngles, CV_64F, cv::Scalar(0));
+    auto accumulator = ReconstructionAccumulator(grid, imageSize);
+    auto firstAngle = size_t(0);
+
+    if (resume && std::filesystem::exists(checkpointPath)) {
+        try {
+            const auto completed =
+                SimulationCheckpoint::load(checkpointPath, inputKey, numAngles, imageSize);
+            firstAngle = completed.cols;
+            completed.copyTo(projections.colRange(0, firstAngle));
+
+            // The back-projection is rebuilt in the order of an uninterrupted run
+            for (size_t i = 0; i < firstAngle; ++i)
+                accumulator.accumulate(projections.col(i), angleForIndex(i, numAngles));
+
+            spdlog::info("Resuming after {}/{} angles.", firstAngle, numAngles);
+        }
+        catch (const std::exception& err) {
+            spdlog::warn("Ignoring checkpoint '{}': {}", checkpointPath, err.what());
+        }
+    }
+
+    // Each checkpoint appends the angles completed since the previous one
+    auto checkpoint = std::optional<SimulationCheckpoint>();
+    if (checkpointInterval > 0) {
+        checkpoint.emplace(
+            checkpointPath, inputKey, numAngles, projections.colRange(0, firstAngle)
+        );
+    }
+    auto numCheckpointed = firstAngle;
+
+    for (size_t i = firstAngle; i < numAngles; ++i) {
+        const auto phi = angleForIndex(i, numAngles);
+        const auto projection = simulateProjectionForAngle(phi);
+
+        accumulator.accumulate(projection, phi);
+        projection.copyTo(projections.col(i));
+
+        // No checkpoint after the last angle, the outputs are written right after
+        const auto numDone = i + 1;
+        if (checkpoint && numDone % checkpointInterval == 0 && numDone < numAngles) {
+            checkpoint->append(projections.colRange(numCheckpointed, numDone));
+            numCheckpointed = numDone;
+        }
+    }
+
+    filterProjections(projections);
+
+    return SimulationResult(accumulator.getNormalizedImage(), std::move(projections));
+}
+
 cv::Mat Simulation::simulateProjectionForAngle(const double phi) const {
     spdlog::debug("Simulating projection for angle: {:.2f} degrees", degrees(phi));
     const auto rays = m_rayTracer.setupRays(phi, m_densityMap.getSize());
+
+    if (m_spectrum) {
+        // Trace every ray once and attenuate all energy bins from the same path lengths
+        const auto& materialBounds = m_spectrum->getMaterialBounds();
+        auto pathLengths = cv::Mat(rays.size(), materialBounds.size(), CV_64F, cv::Scalar(0));
+
+        for (size_t i = 0; i < rays.size(); ++i) {
+            const auto rayPathLengths = m_rayTracer.traceRayPerMaterial(rays[i], materialBounds);
+            for (size_t material = 0; material < rayPathLengths.size(); ++material)
+                pathLengths.at<double>(i, material) = rayPathLengths[material];
+        }
+
+        return m_spectrum->attenuate(pathLengths);
+    }
+
     auto projection = cv::Mat(m_densityMap.getSize(), 1, CV_64F, cv::Scalar(0));
 
     for (size_t i = 0; i < rays.size(); ++i)
@@ -41,64 +403,69 @@ cv::Mat Simulation::simulateProjectionForAngle(const double phi) const {
     return projection;
 }
 
-cv::Mat& Simulation::filterProjections(cv::Mat& projections) const {
+cv::Mat& Simulation::filterProjections(cv::Mat& projections) {
     cv::normalize(projections, projections, 0.0, 1.0, cv::NORM_MINMAX);
 
     return projections;
 }
 
 cv::Mat Simulation::backProject(const cv::Mat& projections) const {
-    spdlog::info("Starting reconstruction of the image from projections.");
+    return backProject(projections, ReconstructionGrid::full(m_densityMap.getSize()));
+}
 
-    const auto imageSize = static_cast<int32_t>(m_densityMap.getSize());
-    auto reconstructedImage = cv::Mat(imageSize, imageSize, CV_64F, cv::Scalar(0));
+cv::Mat Simulation::backProject(const cv::Mat& projections, const ReconstructionGrid& grid) const {
+    spdlog::info("Starting reconstruction of the image from projections.");
 
-    const auto center = static_cast<double>(imageSize) / 2.0;
+    // The projections are normalized already, so only their sum is needed
+    auto accumulator =
+        ReconstructionAccumulator(grid, m_densityMap.getSize(), 1, Normalization::None);
     const auto numAngles = static_cast<size_t>(projections.cols);
 
-    for (size_t i = 0; i < numAngles; i++) {
-        const auto phi = radians(static_cast<double>(i) * (360.0 / numAngles));
-        const auto cosAngle = cos(phi);
-        const auto sinAngle = sin(phi);
-
-        spdlog::debug("Processing angle {} ({} degrees)", i, degrees(phi));
-
-        for (int32_t y = 0; y < imageSize; y++) {
-            for (int32_t x = 0; x < imageSize; x++) {
-                const auto xRel = static_cast<double>(x) - center;
-                const auto yRel = static_cast<double>(y) - center;
-
-                const auto t = -xRel * sinAngle + yRel * cosAngle;
-
-                const auto detectorCenter = static_cast<double>(imageSize) / 2.0;
-                const auto detectorIndex = t + detectorCenter;
-
-                const auto index0 = static_cast<int32_t>(std::floor(detectorIndex));
-                const auto index1 = index0 + 1;
-                const auto weight1 = detectorIndex - static_cast<double>(index0);
-                const auto weight0 = 1.0 - weight1;
-
-                auto projectionValue = 0.0;
-
-                if (index0 >= 0 && index1 < imageSize) {
-                    const auto value0 = projections.at<double>(index0, i);
-                    const auto value1 = projections.at<double>(index1, i);
-                    projectionValue = weight0 * value0 + weight1 * value1;
-                }
-                else if (index0 >= 0 && index0 < imageSize) {
-                    projectionValue = projections.at<double>(index0, i);
-                }
-                else if (index1 >= 0 && index1 < imageSize) {
-                    projectionValue = projections.at<double>(index1, i);
-                }
-                else {
-                    continue;
-                }
-
-                reconstructedImage.at<double>(y, x) += projectionValue;
+    for (size_t i = 0; i < numAngles; i++)
+        accumulator.accumulate(projections.col(i), angleForIndex(i, numAngles));
+
+    return accumulator.getImage();
+}
+
+double Simulation::angleForIndex(const std::size_t index, const std::size_t numAngles) noexcept {
+    return radians(static_cast<double>(index) * (360.0 / numAngles));
+}
+
+std::vector<size_t> Simulation::orderAngles(const std::size_t numAngles, const AngleOrder order) {
+    auto indices = std::vector<size_t>();
+    indices.reserve(numAngles);
+
+    switch (order) {
+        case AngleOrder::Sequential:
+            for (size_t i = 0; i < numAngles; ++i) indices.push_back(i);
+            break;
+
+        case AngleOrder::BitReversed: {
+            // Reverse the bits of every index below the next power of two and skip the ones that
+            // land past the end
+            const auto numBits = std::bit_width(std::bit_ceil(numAngles)) - 1;
+            for (size_t k = 0; k < std::bit_ceil(numAngles); ++k) {
+                auto reversed = size_t(0);
+                for (size_t bit = 0; bit < numBits; ++bit)
+                    reversed |= ((k >> bit) & 1) << (numBits - 1 - bit);
+
+                if (reversed < numAngles) indices.push_back(reversed);
             }
+            break;
+        }
+
+        case AngleOrder::GoldenAngle: {
+            // Step by the index closest to the golden angle (360 / phi^2 degrees) that is coprime
+            // with numAngles, so that the walk visits every index exactly once
+            const auto goldenRatio = (1.0 + std::sqrt(5.0)) / 2.0;
+            auto step = static_cast<size_t>(std::round(numAngles / (goldenRatio * goldenRatio)));
+            step = std::max(step, size_t(1));
+            while (std::gcd(step, numAngles) > 1) ++step;
+
+            for (size_t k = 0; k < numAngles; ++k) indices.push_back((k * step) % numAngles);
+            break;
         }
     }
 
-    return reconstructedImage;
+    return indices;
 }
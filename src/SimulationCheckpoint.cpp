@@ -0,0 +1,104 @@
+#include "SimulationCheckpoint.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+#include "MatIO.hpp"
+
+namespace fs = std::filesystem;
+
+using std::size_t;
+
+namespace {
+
+const auto CHECKPOINT_MAGIC = std::string("CTCHKPT");
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+}  // namespace
+
+SimulationCheckpoint::SimulationCheckpoint(
+    const std::string& outputPath,
+    const std::string& inputKey,
+    const std::size_t numAngles,
+    const cv::Mat& completed
+)
+    : m_outputPath(outputPath),
+      m_file() {
+    const auto tmpPath = outputPath + ".tmp";
+
+    {
+        auto file = std::ofstream(tmpPath, std::ios::binary | std::ios::trunc);
+        MatIO::writeHeader(file, CHECKPOINT_MAGIC, CHECKPOINT_VERSION);
+        MatIO::writeString(file, inputKey);
+        MatIO::writeValue<uint64_t>(file, numAngles);
+        MatIO::writeValue<uint64_t>(file, completed.rows);
+        if (completed.cols > 0) MatIO::writeMat(file, completed);
+
+        if (!file.flush()) {
+            spdlog::error("Failed to write checkpoint to '{}'.", tmpPath);
+            throw std::runtime_error("Failed to write checkpoint.");
+        }
+    }
+
+    fs::rename(tmpPath, outputPath);
+    m_file.open(outputPath, std::ios::binary | std::ios::app);
+}
+
+void SimulationCheckpoint::append(const cv::Mat& projections) {
+    MatIO::writeMat(m_file, projections);
+
+    if (!m_file.flush()) {
+        spdlog::error("Failed to append to checkpoint '{}'.", m_outputPath);
+        throw std::runtime_error("Failed to write checkpoint.");
+    }
+
+    spdlog::info("Checkpointed {} more angles to '{}'.", projections.cols, m_outputPath);
+}
+
+cv::Mat SimulationCheckpoint::load(
+    const std::string& inputPath,
+    const std::string& inputKey,
+    const std::size_t numAngles,
+    const std::size_t detectorSize
+) {
+    auto file = std::ifstream(inputPath, std::ios::binary);
+    if (!file) throw std::runtime_error("Failed to open checkpoint.");
+
+    MatIO::readHeader(file, CHECKPOINT_MAGIC, CHECKPOINT_VERSION);
+    if (MatIO::readString(file) != inputKey || MatIO::readValue<uint64_t>(file) != numAngles ||
+        MatIO::readValue<uint64_t>(file) != detectorSize)
+        throw std::runtime_error("Checkpoint belongs to a different scan.");
+
+    auto blocks = std::vector<cv::Mat>();
+    auto numCompleted = size_t(0);
+
+    while (file.peek() != std::ifstream::traits_type::eof()) {
+        auto block = cv::Mat();
+        try {
+            block = MatIO::readMat(file);
+        }
+        catch (const std::runtime_error&) {
+            // The last block was cut short by the interruption
+            break;
+        }
+
+        if (static_cast<size_t>(block.rows) != detectorSize || block.type() != CV_64F ||
+            numCompleted + block.cols > numAngles)
+            throw std::runtime_error("Corrupt checkpoint.");
+
+        numCompleted += block.cols;
+        blocks.push_back(std::move(block));
+    }
+
+    auto completed = cv::Mat(detectorSize, numCompleted, CV_64F);
+    auto column = 0;
+    for (const auto& block : blocks) {
+        block.copyTo(completed.colRange(column, column + block.cols));
+        column += block.cols;
+    }
+
+    return completed;
+}
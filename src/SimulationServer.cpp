@@ -0,0 +1,448 @@
+#include "SimulationServer.hpp"
+
+#include <fmt/core.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <unordered_map>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+using std::size_t;
+
+namespace {
+
+constexpr size_t MAX_REQUEST_LENGTH = 4096;
+
+// Connections that have not sent their request line yet are answered with an error after this
+// time, or right away beyond MAX_PENDING_REQUESTS
+constexpr auto REQUEST_TIMEOUT = std::chrono::seconds(5);
+constexpr size_t MAX_PENDING_REQUESTS = 256;
+constexpr int POLL_INTERVAL_MS = 500;
+
+/**
+ * @brief A connection whose request line is still being received.
+ */
+struct PendingRequest {
+    std::string request;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+/**
+ * @brief Sends a response line to a client and closes the connection.
+ */
+void respond(const int client, const std::string& response) {
+#ifndef _WIN32
+    const auto line = response + "\n";
+    for (size_t sent = 0; sent < line.size();) {
+        const auto count = ::send(client, line.data() + sent, line.size() - sent, 0);
+        if (count <= 0) break;
+        sent += static_cast<size_t>(count);
+    }
+
+    ::close(client);
+#else
+    (void)client;
+    (void)response;
+#endif
+}
+
+/**
+ * @brief Switches a socket between blocking and non-blocking mode.
+ */
+void setNonBlocking(const int socket, const bool nonBlocking) {
+#ifndef _WIN32
+    const auto flags = ::fcntl(socket, F_GETFL, 0);
+    ::fcntl(socket, F_SETFL, nonBlocking ? flags | O_NONBLOCK : flags & ~O_NONBLOCK);
+#else
+    (void)socket;
+    (void)nonBlocking;
+#endif
+}
+
+/**
+ * @brief Reads what a non-blocking client has sent of its request line, without waiting for more.
+ * Returns true once the request is complete, i.e. at the line break, when the client stops
+ * sending or at MAX_REQUEST_LENGTH. The line break is not included.
+ */
+bool receiveRequest(const int client, std::string& request) {
+#ifndef _WIN32
+    char buffer[512];
+
+    while (request.size() < MAX_REQUEST_LENGTH) {
+        const auto count = ::recv(client, buffer, sizeof(buffer), 0);
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return false;
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+
+        const auto received = std::string_view(buffer, static_cast<size_t>(count));
+        const auto end = received.find('\n');
+        request += received.substr(0, end);
+        if (end != std::string_view::npos) break;
+    }
+
+    request.resize(std::min(request.size(), MAX_REQUEST_LENGTH));
+    if (!request.empty() && request.back() == '\r') request.pop_back();
+#else
+    (void)client;
+    (void)request;
+#endif
+
+    return true;
+}
+
+/**
+ * @brief Parses a positive count of a request field.
+ */
+size_t parseCount(const std::string& key, const std::string& value) {
+    auto count = size_t(0);
+    auto stream = std::istringstream(value);
+    if (!(stream >> count) || !stream.eof() || count == 0)
+        throw std::invalid_argument(fmt::format("Invalid {} '{}'.", key, value));
+
+    return count;
+}
+
+/**
+ * @brief Loads a density map from a POSIX shared memory object holding a size x size 8-bit
+ * grayscale image.
+ */
+DensityMap loadSharedMemory(const std::string& name, const size_t size) {
+#ifndef _WIN32
+    const auto bytes = size * size;
+    const auto fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+
+    struct stat status = {};
+    if (fd < 0 || ::fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < bytes) {
+        if (fd >= 0) ::close(fd);
+        throw std::invalid_argument(fmt::format("Cannot read {} bytes from '{}'.", bytes, name));
+    }
+
+    auto* data = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error(fmt::format("Cannot map '{}'.", name));
+
+    // The density map converts the image into its own buffer, so the mapping can go right away
+    auto densityMap = DensityMap(cv::Mat(size, size, CV_8U, data));
+    ::munmap(data, bytes);
+
+    return densityMap;
+#else
+    (void)size;
+    throw std::runtime_error(fmt::format("Shared memory input '{}' is not supported.", name));
+#endif
+}
+
+}  // namespace
+
+SimulationServer::SimulationServer(
+    const std::string& socketPath,
+    const std::size_t numWorkers,
+    const std::size_t queueDepth,
+    const std::size_t maxBatch,
+    const std::size_t cacheEntries
+)
+    : m_socketPath(socketPath),
+      m_numWorkers(std::max(numWorkers, size_t(1))),
+      m_maxBatch(std::max(maxBatch, size_t(1))),
+      m_cacheEntries(cacheEntries),
+      m_jobs(queueDepth),
+      m_writer(m_numWorkers),
+      m_cacheMutex(),
+      m_cache() { }
+
+void SimulationServer::run() {
+#ifndef _WIN32
+    auto address = sockaddr_un {};
+    address.sun_family = AF_UNIX;
+    if (m_socketPath.size() >= sizeof(address.sun_path)) {
+        spdlog::error("Socket path '{}' is too long.", m_socketPath);
+        throw std::runtime_error("Socket path is too long.");
+    }
+    m_socketPath.copy(address.sun_path, m_socketPath.size());
+
+    // A socket file left behind by a previous server would make bind fail
+    ::unlink(m_socketPath.c_str());
+
+    const auto listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address))
+        || ::listen(listener, SOMAXCONN)) {
+        if (listener >= 0) ::close(listener);
+        spdlog::error("Failed to listen on '{}'.", m_socketPath);
+        throw std::runtime_error("Failed to create server socket.");
+    }
+
+    // Clients that disconnect early must not terminate the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    auto workers = std::vector<std::thread>();
+    for (size_t i = 0; i < m_numWorkers; ++i) workers.emplace_back([this] { work(); });
+
+    spdlog::info("Serving on '{}' with {} workers.", m_socketPath, m_numWorkers);
+
+    // Requests are read without blocking, so a slow client cannot hold up the others, and a full
+    // queue is answered right away instead of stalling this loop
+    auto pendingRequests = std::unordered_map<int, PendingRequest>();
+
+    for (auto serving = true; serving;) {
+        auto sockets = std::vector<pollfd> { { listener, POLLIN, 0 } };
+        for (const auto& [client, pending] : pendingRequests)
+            sockets.push_back({ client, POLLIN, 0 });
+
+        if (::poll(sockets.data(), sockets.size(), POLL_INTERVAL_MS) < 0) {
+            if (errno == EINTR) continue;
+            spdlog::error("Failed to wait for connections on '{}'.", m_socketPath);
+            break;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        for (size_t i = 1; i < sockets.size() && serving; ++i) {
+            const auto client = sockets[i].fd;
+            auto& pending = pendingRequests.at(client);
+
+            const auto complete =
+                sockets[i].revents != 0 && receiveRequest(client, pending.request);
+            if (!complete && now < pending.deadline) continue;
+
+            const auto request = std::move(pending.request);
+            pendingRequests.erase(client);
+            setNonBlocking(client, false);
+
+            if (!complete) respond(client, "error Timed out waiting for the request.");
+            else if (request == "shutdown") {
+                respond(client, "ok");
+                serving = false;
+            }
+            else queue(client, request);
+        }
+
+        if (!serving || !(sockets[0].revents & POLLIN)) continue;
+
+        const auto client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNABORTED)
+                continue;
+            spdlog::error("Failed to accept connection on '{}'.", m_socketPath);
+            break;
+        }
+
+        if (pendingRequests.size() >= MAX_PENDING_REQUESTS) {
+            respond(client, "error busy: too many connections, retry later.");
+            continue;
+        }
+
+        setNonBlocking(client, true);
+        pendingRequests.emplace(client, PendingRequest { std::string(), now + REQUEST_TIMEOUT });
+    }
+
+    for (const auto& [client, pending] : pendingRequests) {
+        setNonBlocking(client, false);
+        respond(client, "error The server is shutting down.");
+    }
+
+    // Finish the queued jobs before shutting down
+    m_jobs.close();
+    for (auto& worker : workers) worker.join();
+    m_writer.join();
+
+    ::close(listener);
+    ::unlink(m_socketPath.c_str());
+    spdlog::info("Server on '{}' stopped.", m_socketPath);
+#else
+    spdlog::error("Serving over '{}' is not supported on Windows.", m_socketPath);
+    throw std::runtime_error("Unix domain sockets are not supported on this platform.");
+#endif
+}
+
+void SimulationServer::queue(const int client, const std::string& request) {
+    try {
+        auto job = parseRequest(request);
+        job.client = client;
+
+        if (!m_jobs.tryPush(std::move(job))) {
+            spdlog::warn("Rejected request '{}': the queue is full.", request);
+            respond(client, "error busy: the queue is full, retry later.");
+        }
+    }
+    catch (const std::exception& err) {
+        spdlog::warn("Rejected request '{}': {}", request, err.what());
+        respond(client, fmt::format("error {}", err.what()));
+    }
+}
+
+SimulationServer::Input::Input(DensityMap&& densityMap)
+    : densityMap(std::move(densityMap)),
+      simulation(this->densityMap) { }
+
+std::string SimulationServer::Job::resultKey() const {
+    return fmt::format("{}|{}|{}|{}", inputPath, shmName, shmSize, angles);
+}
+
+SimulationServer::Job SimulationServer::parseRequest(const std::string& request) {
+    auto job = Job();
+    job.client = -1;
+    job.shmSize = 0;
+    job.angles = 0;
+    job.formats = { OutputFormat::Png8 };
+    job.received = std::chrono::steady_clock::now();
+
+    auto stream = std::istringstream(request);
+
+    for (auto field = std::string(); stream >> field;) {
+        const auto separator = field.find('=');
+        if (separator == std::string::npos)
+            throw std::invalid_argument(fmt::format("Expected key=value, got '{}'.", field));
+
+        const auto key = field.substr(0, separator);
+        const auto value = field.substr(separator + 1);
+
+        if (key == "input") job.inputPath = value;
+        else if (key == "shm") job.shmName = value;
+        else if (key == "size") job.shmSize = parseCount(key, value);
+        else if (key == "output") job.outputPath = value;
+        else if (key == "angles") job.angles = parseCount(key, value);
+        else if (key == "formats") {
+            job.formats.clear();
+            auto names = std::istringstream(value);
+            for (auto name = std::string(); std::getline(names, name, ',');) {
+                const auto format = ImageWriter::formatFromName(name);
+                if (!format)
+                    throw std::invalid_argument(fmt::format("Unknown output format '{}'.", name));
+                job.formats.push_back(*format);
+            }
+        }
+        else throw std::invalid_argument(fmt::format("Unknown key '{}'.", key));
+    }
+
+    if (job.inputPath.empty() == job.shmName.empty())
+        throw std::invalid_argument("Exactly one of input and shm is required.");
+    if (!job.shmName.empty() && job.shmSize == 0)
+        throw std::invalid_argument("Shared memory input requires a size.");
+    if (job.outputPath.empty()) throw std::invalid_argument("An output directory is required.");
+    if (job.angles == 0) throw std::invalid_argument("At least one angle is required.");
+    if (job.formats.empty()) throw std::invalid_argument("At least one format is required.");
+
+    return job;
+}
+
+void SimulationServer::work() {
+    while (auto first = m_jobs.pop()) {
+        auto batch = std::vector<Job> { std::move(*first) };
+        while (batch.size() < m_maxBatch) {
+            auto next = m_jobs.tryPop();
+            if (!next) break;
+            batch.push_back(std::move(*next));
+        }
+
+        // Identical jobs in a batch share one simulation
+        auto results = std::map<std::string, SimulationResult>();
+
+        for (const auto& job : batch) {
+            try {
+                auto result = results.find(job.resultKey());
+                if (result == results.end())
+                    result = results.emplace(job.resultKey(), simulate(job)).first;
+
+                save(job, result->second);
+
+                const auto elapsed = std::chrono::steady_clock::now() - job.received;
+                respond(
+                    job.client,
+                    fmt::format(
+                        "ok {}",
+                        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                    )
+                );
+            }
+            catch (const std::exception& err) {
+                spdlog::warn("Job for '{}' failed: {}", job.outputPath, err.what());
+                respond(job.client, fmt::format("error {}", err.what()));
+            }
+        }
+    }
+}
+
+SimulationResult SimulationServer::simulate(const Job& job) {
+    // Shared memory buffers are reused by clients for different inputs, so they are not cached
+    const auto input = job.shmName.empty()
+                           ? cachedInput(job.inputPath)
+                           : std::make_shared<const Input>(
+                                 loadSharedMemory(job.shmName, job.shmSize)
+                             );
+
+    return input->simulation.simulateCT(job.angles);
+}
+
+std::shared_ptr<const SimulationServer::Input> SimulationServer::cachedInput(
+    const std::string& inputPath
+) {
+    auto error = std::error_code();
+    const auto modified = fs::last_write_time(inputPath, error);
+    if (error) throw std::invalid_argument(fmt::format("Cannot read '{}'.", inputPath));
+
+    const auto key = fmt::format("{}@{}", inputPath, modified.time_since_epoch().count());
+
+    {
+        auto lock = std::lock_guard(m_cacheMutex);
+        const auto entry = std::find_if(m_cache.begin(), m_cache.end(), [&](const auto& e) {
+            return e.first == key;
+        });
+
+        if (entry != m_cache.end()) {
+            m_cache.splice(m_cache.begin(), m_cache, entry);
+            return entry->second;
+        }
+    }
+
+    // Load outside the lock, so other workers are not held up by the decode
+    const auto image = cv::imread(inputPath, cv::IMREAD_GRAYSCALE);
+    if (image.empty()) throw std::invalid_argument(fmt::format("Cannot load '{}'.", inputPath));
+    if (image.rows != image.cols)
+        throw std::invalid_argument(fmt::format("Input '{}' is not square.", inputPath));
+
+    const auto input = std::make_shared<const Input>(DensityMap(image));
+
+    auto lock = std::lock_guard(m_cacheMutex);
+    if (std::none_of(m_cache.begin(), m_cache.end(), [&](const auto& e) { return e.first == key; }))
+        m_cache.emplace_front(key, input);
+    if (m_cache.size() > m_cacheEntries) m_cache.pop_back();
+
+    return input;
+}
+
+void SimulationServer::save(const Job& job, const SimulationResult& result) {
+    fs::create_directories(job.outputPath);
+
+    auto written = std::vector<std::future<void>>();
+    for (const auto format : job.formats) {
+        written.push_back(m_writer.write(
+            result.getProjections(), fs::path(job.outputPath) / "projections", format
+        ));
+        written.push_back(m_writer.write(
+            result.getImage(), fs::path(job.outputPath) / "reconstructed_image", format
+        ));
+    }
+
+    // Waits for every write, get rethrows the error of a failed one
+    for (auto& image : written) image.get();
+}
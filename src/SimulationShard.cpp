@@ -0,0 +1,160 @@
+#include "SimulationShard.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "MatIO.hpp"
+#include "Simulation.hpp"
+
+namespace fs = std::filesystem;
+
+using std::size_t;
+using std::vector;
+
+namespace {
+
+const auto SHARD_MAGIC = std::string("CTSHARD");
+constexpr uint32_t SHARD_VERSION = 3;
+
+}  // namespace
+
+SimulationShard::SimulationShard(
+    const std::string& inputKey,
+    const std::size_t numAngles,
+    const std::size_t angleBegin,
+    const std::size_t angleEnd,
+    cv::Mat&& projections,
+    ReconstructionAccumulator&& accumulator
+)
+    : m_inputKey(inputKey),
+      m_numAngles(numAngles),
+      m_angleBegin(angleBegin),
+      m_angleEnd(angleEnd),
+      m_projections(std::move(projections)),
+      m_accumulator(std::move(accumulator)) { }
+
+const std::string& SimulationShard::getInputKey() const noexcept {
+    return m_inputKey;
+}
+
+size_t SimulationShard::getNumAngles() const noexcept {
+    return m_numAngles;
+}
+
+size_t SimulationShard::getAngleBegin() const noexcept {
+    return m_angleBegin;
+}
+
+size_t SimulationShard::getAngleEnd() const noexcept {
+    return m_angleEnd;
+}
+
+const cv::Mat& SimulationShard::getProjections() const noexcept {
+    return m_projections;
+}
+
+const ReconstructionAccumulator& SimulationShard::getAccumulator() const noexcept {
+    return m_accumulator;
+}
+
+void SimulationShard::save(const std::string& outputPath) const {
+    const auto tmpPath = outputPath + ".tmp";
+
+    {
+        auto file = std::ofstream(tmpPath, std::ios::binary | std::ios::trunc);
+        MatIO::writeHeader(file, SHARD_MAGIC, SHARD_VERSION);
+        MatIO::writeString(file, m_inputKey);
+        MatIO::writeValue<uint64_t>(file, m_numAngles);
+        MatIO::writeValue<uint64_t>(file, m_angleBegin);
+        MatIO::writeValue<uint64_t>(file, m_angleEnd);
+        MatIO::writeMat(file, m_projections);
+        m_accumulator.write(file);
+
+        if (!file.flush()) {
+            spdlog::error("Failed to write shard to '{}'.", tmpPath);
+            throw std::runtime_error("Failed to write shard.");
+        }
+    }
+
+    fs::rename(tmpPath, outputPath);
+    spdlog::info("Saved shard of angles [{}, {}) as '{}'.", m_angleBegin, m_angleEnd, outputPath);
+}
+
+SimulationShard SimulationShard::load(const std::string& inputPath) {
+    spdlog::info("Loading shard from: {}", inputPath);
+
+    auto file = std::ifstream(inputPath, std::ios::binary);
+    if (!file) {
+        spdlog::error("Failed to open shard: {}", inputPath);
+        throw std::runtime_error("Failed to open shard.");
+    }
+
+    MatIO::readHeader(file, SHARD_MAGIC, SHARD_VERSION);
+    const auto inputKey = MatIO::readString(file);
+    const auto numAngles = MatIO::readValue<uint64_t>(file);
+    const auto angleBegin = MatIO::readValue<uint64_t>(file);
+    const auto angleEnd = MatIO::readValue<uint64_t>(file);
+    auto projections = MatIO::readMat(file);
+    auto accumulator = ReconstructionAccumulator::read(file);
+
+    if (angleBegin > angleEnd || angleEnd > numAngles ||
+        static_cast<size_t>(projections.cols) != angleEnd - angleBegin) {
+        spdlog::error("Shard '{}' has an inconsistent angle range.", inputPath);
+        throw std::runtime_error("Corrupt shard.");
+    }
+
+    return SimulationShard(
+        inputKey, numAngles, angleBegin, angleEnd, std::move(projections), std::move(accumulator)
+    );
+}
+
+SimulationResult SimulationShard::merge(const vector<SimulationShard>& shards) {
+    if (shards.empty()) throw std::invalid_argument("No shards to merge.");
+
+    auto order = vector<const SimulationShard*>();
+    for (const auto& shard : shards) order.push_back(&shard);
+    std::ranges::sort(order, {}, &SimulationShard::m_angleBegin);
+
+    const auto numAngles = order.front()->m_numAngles;
+    const auto imageSize = order.front()->m_projections.rows;
+    spdlog::info("Merging {} shards of a scan with {} angles.", shards.size(), numAngles);
+
+    auto projections = cv::Mat(imageSize, numAngles, CV_64F, cv::Scalar(0));
+    auto accumulator = order.front()->m_accumulator.clone();
+    auto nextAngle = size_t(0);
+
+    for (const auto* shard : order) {
+        if (shard->m_inputKey != order.front()->m_inputKey || shard->m_numAngles != numAngles ||
+            shard->m_projections.rows != imageSize) {
+            spdlog::error("Shards belong to different scans.");
+            throw std::invalid_argument("Shards belong to different scans.");
+        }
+        if (shard->m_angleBegin != nextAngle) {
+            spdlog::error(
+                "Shards do not cover the angles exactly once: expected a shard starting at {}, "
+                "got [{}, {}).",
+                nextAngle,
+                shard->m_angleBegin,
+                shard->m_angleEnd
+            );
+            throw std::invalid_argument("Shards do not cover the scan exactly once.");
+        }
+
+        shard->m_projections.copyTo(projections.colRange(shard->m_angleBegin, shard->m_angleEnd));
+        if (shard != order.front()) accumulator.merge(shard->m_accumulator);
+        nextAngle = shard->m_angleEnd;
+    }
+
+    if (nextAngle != numAngles) {
+        spdlog::error("Shards end at angle {}, the scan has {} angles.", nextAngle, numAngles);
+        throw std::invalid_argument("Shards do not cover the scan exactly once.");
+    }
+
+    Simulation::filterProjections(projections);
+
+    return SimulationResult(accumulator.getNormalizedImage(), std::move(projections));
+}
@@ -0,0 +1,320 @@
+#include "SinogramArchive.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "MatIO.hpp"
+
+namespace fs = std::filesystem;
+
+using std::size_t;
+
+namespace {
+
+const auto SINOGRAM_MAGIC = std::string("CTSINO");
+constexpr uint32_t SINOGRAM_VERSION = 2;
+constexpr size_t SINOGRAM_HEADER_SIZE = 64;
+constexpr size_t INDEX_ENTRY_SIZE = sizeof(double) + 2 * sizeof(uint64_t);
+
+/**
+ * @brief Returns the byte offset of an index entry. The offset of the entry past the last one is
+ * where the projections start.
+ */
+uint64_t entryOffset(const size_t index) {
+    return SINOGRAM_HEADER_SIZE + index * INDEX_ENTRY_SIZE;
+}
+
+/**
+ * @brief Reads a value from a possibly unaligned position of the mapping.
+ */
+template <typename T>
+T readAt(const unsigned char* data) {
+    auto value = T();
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Appends the differences of consecutive bit patterns, zigzag and varint coded, so values
+ * close to their predecessor take few bytes.
+ */
+void encodeDelta(const double* values, const size_t count, std::vector<unsigned char>& encoded) {
+    auto previous = uint64_t(0);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto bits = std::bit_cast<uint64_t>(values[i]);
+        const auto delta = bits - previous;
+        previous = bits;
+
+        auto zigzag = (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+        for (; zigzag >= 0x80; zigzag >>= 7)
+            encoded.push_back(static_cast<unsigned char>(zigzag | 0x80));
+        encoded.push_back(static_cast<unsigned char>(zigzag));
+    }
+}
+
+/**
+ * @brief Decodes the output of encodeDelta. Throws std::runtime_error on malformed input.
+ */
+void decodeDelta(const unsigned char* encoded, const size_t size, double* values, size_t count) {
+    auto previous = uint64_t(0);
+    auto position = size_t(0);
+
+    for (size_t i = 0; i < count; ++i) {
+        auto zigzag = uint64_t(0);
+        for (auto shift = 0;; shift += 7) {
+            if (position == size || shift > 63)
+                throw std::runtime_error("Malformed delta-coded projection.");
+
+            const auto byte = encoded[position++];
+            zigzag |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+
+        previous += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+        values[i] = std::bit_cast<double>(previous);
+    }
+}
+
+}  // namespace
+
+SinogramWriter::SinogramWriter(
+    const std::string& outputPath,
+    const std::size_t detectorSize,
+    const std::size_t numAngles,
+    const SinogramEncoding encoding
+)
+    : m_outputPath(outputPath),
+      m_tmpPath(outputPath + ".tmp"),
+      m_file(m_tmpPath, std::ios::binary | std::ios::trunc),
+      m_detectorSize(detectorSize),
+      m_numAngles(numAngles),
+      m_encoding(encoding),
+      m_numWritten(0),
+      m_dataEnd(entryOffset(numAngles)) {
+    MatIO::writeHeader(m_file, SINOGRAM_MAGIC, SINOGRAM_VERSION);
+    MatIO::writeValue<uint64_t>(m_file, m_detectorSize);
+    MatIO::writeValue<uint64_t>(m_file, m_numAngles);
+    MatIO::writeValue<uint32_t>(m_file, static_cast<uint32_t>(m_encoding));
+
+    // Zero the rest of the header and the index, entries are filled in by append
+    const auto padding = m_dataEnd - static_cast<uint64_t>(m_file.tellp());
+    m_file.write(std::string(padding, '\0').data(), static_cast<std::streamsize>(padding));
+
+    if (!m_file) {
+        spdlog::error("Failed to create sinogram archive '{}'.", m_tmpPath);
+        discard();
+        throw std::runtime_error("Failed to create sinogram archive.");
+    }
+}
+
+SinogramWriter::SinogramWriter(SinogramWriter&& other) noexcept
+    : m_outputPath(std::move(other.m_outputPath)),
+      m_tmpPath(std::exchange(other.m_tmpPath, std::string())),
+      m_file(std::move(other.m_file)),
+      m_detectorSize(other.m_detectorSize),
+      m_numAngles(other.m_numAngles),
+      m_encoding(other.m_encoding),
+      m_numWritten(other.m_numWritten),
+      m_dataEnd(other.m_dataEnd) { }
+
+SinogramWriter& SinogramWriter::operator=(SinogramWriter&& other) noexcept {
+    if (this != &other) {
+        discard();
+        m_outputPath = std::move(other.m_outputPath);
+        m_tmpPath = std::exchange(other.m_tmpPath, std::string());
+        m_file = std::move(other.m_file);
+        m_detectorSize = other.m_detectorSize;
+        m_numAngles = other.m_numAngles;
+        m_encoding = other.m_encoding;
+        m_numWritten = other.m_numWritten;
+        m_dataEnd = other.m_dataEnd;
+    }
+
+    return *this;
+}
+
+SinogramWriter::~SinogramWriter() {
+    discard();
+}
+
+void SinogramWriter::append(const cv::Mat& projection, const double phi) {
+    if (m_numWritten == m_numAngles) {
+        spdlog::error("Sinogram archive '{}' is already full.", m_tmpPath);
+        throw std::invalid_argument("Sinogram archive is full.");
+    }
+    if (projection.total() != m_detectorSize) {
+        spdlog::error("Projection has {} values, expected {}.", projection.total(), m_detectorSize);
+        throw std::invalid_argument("Projection size does not match the sinogram archive.");
+    }
+
+    // Column views of a sinogram are not continuous
+    auto values = cv::Mat();
+    projection.convertTo(values, m_encoding == SinogramEncoding::Float32 ? CV_32F : CV_64F);
+
+    auto encoded = std::vector<unsigned char>();
+    if (m_encoding == SinogramEncoding::Delta)
+        encodeDelta(values.ptr<double>(), m_detectorSize, encoded);
+    else
+        encoded.assign(values.data, values.data + values.total() * values.elemSize());
+
+    const auto offset = m_dataEnd;
+    const auto size = static_cast<uint64_t>(encoded.size());
+
+    // Keep every projection 8-byte aligned, so mapped values can be read in place
+    encoded.resize((encoded.size() + 7) / 8 * 8, 0);
+    m_file.seekp(static_cast<std::streamoff>(offset));
+    m_file.write(
+        reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size())
+    );
+
+    m_file.seekp(static_cast<std::streamoff>(entryOffset(m_numWritten)));
+    MatIO::writeValue<double>(m_file, phi);
+    MatIO::writeValue<uint64_t>(m_file, offset);
+    MatIO::writeValue<uint64_t>(m_file, size);
+
+    if (!m_file) {
+        spdlog::error("Failed to append projection {} to '{}'.", m_numWritten, m_tmpPath);
+        discard();
+        throw std::runtime_error("Failed to write sinogram archive.");
+    }
+
+    m_dataEnd += encoded.size();
+    ++m_numWritten;
+}
+
+void SinogramWriter::finish() {
+    if (m_numWritten != m_numAngles) {
+        spdlog::error(
+            "Sinogram archive '{}' holds {} of {} projections.",
+            m_tmpPath,
+            m_numWritten,
+            m_numAngles
+        );
+        discard();
+        throw std::runtime_error("Sinogram archive is incomplete.");
+    }
+
+    m_file.close();
+    auto error = std::error_code();
+    if (!m_file.fail()) fs::rename(m_tmpPath, m_outputPath, error);
+    if (m_file.fail() || error) {
+        spdlog::error("Failed to write sinogram archive '{}'.", m_outputPath);
+        discard();
+        throw std::runtime_error("Failed to write sinogram archive.");
+    }
+
+    m_tmpPath.clear();
+    spdlog::info("Saved sinogram archive as '{}'.", m_outputPath);
+}
+
+void SinogramWriter::discard() noexcept {
+    if (m_tmpPath.empty()) return;
+
+    m_file.close();
+    auto error = std::error_code();
+    fs::remove(m_tmpPath, error);
+    m_tmpPath.clear();
+}
+
+SinogramArchive::SinogramArchive(const std::string& inputPath)
+    : m_file(inputPath),
+      m_detectorSize(0),
+      m_numAngles(0),
+      m_encoding(SinogramEncoding::Float64) {
+    if (m_file.size() < SINOGRAM_HEADER_SIZE) {
+        spdlog::error("'{}' is not a sinogram archive.", inputPath);
+        throw std::runtime_error("Not a sinogram archive.");
+    }
+
+    auto header = std::istringstream(
+        std::string(reinterpret_cast<const char*>(m_file.data()), SINOGRAM_HEADER_SIZE)
+    );
+    MatIO::readHeader(header, SINOGRAM_MAGIC, SINOGRAM_VERSION);
+    m_detectorSize = MatIO::readValue<uint64_t>(header);
+    m_numAngles = MatIO::readValue<uint64_t>(header);
+    m_encoding = static_cast<SinogramEncoding>(MatIO::readValue<uint32_t>(header));
+
+    // Check the sizes against the file before computing offsets from them, so a corrupt header
+    // cannot overflow them. Every value takes at least one byte, even delta-coded.
+    const auto valueSize = m_encoding == SinogramEncoding::Float32 ? sizeof(float) : sizeof(double);
+    const auto minValueSize = m_encoding == SinogramEncoding::Delta ? size_t(1) : valueSize;
+    const auto maxNumAngles = (m_file.size() - SINOGRAM_HEADER_SIZE) / INDEX_ENTRY_SIZE;
+    const auto maxDetectorSize =
+        std::min<size_t>(m_file.size() / minValueSize, std::numeric_limits<int>::max());
+
+    if (m_encoding > SinogramEncoding::Delta || m_numAngles > maxNumAngles ||
+        (m_numAngles > 0 && m_detectorSize > maxDetectorSize)) {
+        spdlog::error("Sinogram archive '{}' has an invalid header.", inputPath);
+        throw std::runtime_error("Invalid sinogram archive.");
+    }
+
+    const auto rawSize = m_detectorSize * valueSize;
+    for (size_t i = 0; i < m_numAngles; ++i) {
+        const auto* entry = m_file.data() + entryOffset(i);
+        const auto offset = readAt<uint64_t>(entry + sizeof(double));
+        const auto size = readAt<uint64_t>(entry + sizeof(double) + sizeof(uint64_t));
+
+        const auto misplaced = offset < entryOffset(m_numAngles) || offset % 8 != 0
+                               || offset > m_file.size() || size > m_file.size() - offset;
+        if (misplaced || (m_encoding != SinogramEncoding::Delta && size != rawSize)) {
+            spdlog::error("Sinogram archive '{}' has an invalid entry {}.", inputPath, i);
+            throw std::runtime_error("Invalid sinogram archive.");
+        }
+    }
+
+    spdlog::info(
+        "Opened sinogram archive '{}' with {} projections of {} values.",
+        inputPath,
+        m_numAngles,
+        m_detectorSize
+    );
+}
+
+size_t SinogramArchive::getDetectorSize() const noexcept {
+    return m_detectorSize;
+}
+
+size_t SinogramArchive::getNumAngles() const noexcept {
+    return m_numAngles;
+}
+
+SinogramEncoding SinogramArchive::getEncoding() const noexcept {
+    return m_encoding;
+}
+
+double SinogramArchive::angle(const std::size_t index) const {
+    if (index >= m_numAngles) throw std::out_of_range("Projection index out of range.");
+
+    return readAt<double>(m_file.data() + entryOffset(index));
+}
+
+cv::Mat SinogramArchive::projection(const std::size_t index) const {
+    if (index >= m_numAngles) throw std::out_of_range("Projection index out of range.");
+
+    const auto* entry = m_file.data() + entryOffset(index);
+    const auto offset = readAt<uint64_t>(entry + sizeof(double));
+    const auto size = readAt<uint64_t>(entry + sizeof(double) + sizeof(uint64_t));
+
+    // The mapping is read-only, the returned matrices must not be written to
+    auto* data = const_cast<unsigned char*>(m_file.data() + offset);
+
+    switch (m_encoding) {
+        case SinogramEncoding::Float64: return cv::Mat(m_detectorSize, 1, CV_64F, data);
+        case SinogramEncoding::Float32: return cv::Mat(m_detectorSize, 1, CV_32F, data);
+        case SinogramEncoding::Delta: break;
+    }
+
+    auto decoded = cv::Mat(m_detectorSize, 1, CV_64F);
+    decodeDelta(data, size, decoded.ptr<double>(), m_detectorSize);
+    return decoded;
+}
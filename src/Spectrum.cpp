@@ -0,0 +1,161 @@
+#include "Spectrum.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+using std::size_t;
+using std::vector;
+
+namespace {
+
+/**
+ * @brief Parses a number of a spectrum file. Throws std::runtime_error if the token is not a
+ * finite number.
+ */
+double parseNumber(const std::string& token, const std::string& spectrumPath, size_t lineNumber) {
+    auto value = 0.0;
+    auto stream = std::istringstream(token);
+    if (!(stream >> value) || !stream.eof() || !std::isfinite(value)) {
+        spdlog::error("{}:{}: '{}' is not a number.", spectrumPath, lineNumber, token);
+        throw std::runtime_error("Malformed spectrum file.");
+    }
+
+    return value;
+}
+
+}  // namespace
+
+Spectrum::Spectrum(const std::string& spectrumPath)
+    : m_materialBounds(),
+      m_attenuation(),
+      m_weights() {
+    loadFromFilepath(spectrumPath);
+}
+
+const vector<double>& Spectrum::getMaterialBounds() const noexcept {
+    return m_materialBounds;
+}
+
+size_t Spectrum::getNumBins() const noexcept {
+    return static_cast<size_t>(m_weights.rows);
+}
+
+cv::Mat Spectrum::attenuate(const cv::Mat& pathLengths) const {
+    // exp(-mu * L) for every ray and energy bin in one matrix, so the exponentials run as a single
+    // vectorized pass
+    auto transmission = cv::Mat();
+    cv::gemm(pathLengths, m_attenuation, 1.0, cv::Mat(), 0.0, transmission);
+    cv::exp(transmission, transmission);
+
+    auto intensity = cv::Mat();
+    cv::gemm(transmission, m_weights, 1.0, cv::Mat(), 0.0, intensity);
+    cv::max(intensity, std::numeric_limits<double>::min(), intensity);
+
+    auto projection = cv::Mat();
+    cv::log(intensity, projection);
+    projection.convertTo(projection, CV_64F, -1.0);
+
+    return projection;
+}
+
+void Spectrum::loadFromFilepath(const std::string& spectrumPath) {
+    spdlog::info("Loading spectrum from: {}", spectrumPath);
+
+    auto file = std::ifstream(spectrumPath);
+    if (!file) {
+        spdlog::error("Failed to open spectrum file: {}", spectrumPath);
+        throw std::runtime_error("Failed to open spectrum file.");
+    }
+
+    auto materialBounds = vector<double>{ 1.0 };
+    auto weights = vector<double>();
+    auto coefficients = vector<vector<double>>();
+
+    auto line = std::string();
+    for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        auto stream = std::istringstream(line);
+        auto tokens = vector<std::string>();
+        for (auto token = std::string(); stream >> token;) tokens.push_back(token);
+
+        if (tokens.empty() || tokens.front().starts_with('#')) continue;
+
+        const auto parse = [&](const std::string& token) {
+            return parseNumber(token, spectrumPath, lineNumber);
+        };
+
+        if (tokens.front() == "materials") {
+            materialBounds.clear();
+            for (size_t i = 1; i < tokens.size(); ++i) materialBounds.push_back(parse(tokens[i]));
+
+            if (materialBounds.empty() || !std::ranges::is_sorted(materialBounds)) {
+                spdlog::error(
+                    "{}:{}: material bounds must be a non-empty ascending list.",
+                    spectrumPath,
+                    lineNumber
+                );
+                throw std::runtime_error("Malformed spectrum file.");
+            }
+            continue;
+        }
+
+        if (tokens.size() < 2) {
+            spdlog::error("{}:{}: energy bin '{}' has no weight.", spectrumPath, lineNumber, line);
+            throw std::runtime_error("Malformed spectrum file.");
+        }
+
+        const auto energy = parse(tokens[0]);
+        const auto weight = parse(tokens[1]);
+        if (weight < 0.0) {
+            spdlog::error("{}:{}: weight {} is negative.", spectrumPath, lineNumber, weight);
+            throw std::runtime_error("Malformed spectrum file.");
+        }
+
+        auto mu = vector<double>();
+        for (size_t i = 2; i < tokens.size(); ++i) mu.push_back(parse(tokens[i]));
+
+        spdlog::debug(
+            "Energy bin {} keV: weight {:.4f}, {} coefficients", energy, weight, mu.size()
+        );
+        weights.push_back(weight);
+        coefficients.push_back(std::move(mu));
+    }
+
+    const auto numMaterials = materialBounds.size();
+    const auto totalWeight = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    if (weights.empty() || !(totalWeight > 0.0)) {
+        spdlog::error("Spectrum must contain at least one bin with positive weight.");
+        throw std::runtime_error("Malformed spectrum file.");
+    }
+
+    m_materialBounds = std::move(materialBounds);
+    m_attenuation = cv::Mat(numMaterials, weights.size(), CV_64F, cv::Scalar(0));
+    m_weights = cv::Mat(weights.size(), 1, CV_64F, cv::Scalar(0));
+
+    for (size_t bin = 0; bin < weights.size(); ++bin) {
+        if (coefficients[bin].size() != numMaterials) {
+            spdlog::error(
+                "Energy bin {} has {} attenuation coefficients, expected {}.",
+                bin,
+                coefficients[bin].size(),
+                numMaterials
+            );
+            throw std::runtime_error("Malformed spectrum file.");
+        }
+
+        m_weights.at<double>(bin, 0) = weights[bin] / totalWeight;
+        for (size_t material = 0; material < numMaterials; ++material)
+            m_attenuation.at<double>(material, bin) = -coefficients[bin][material];
+    }
+
+    spdlog::info(
+        "Spectrum loaded with {} energy bins and {} materials.", weights.size(), numMaterials
+    );
+}
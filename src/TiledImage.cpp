@@ -0,0 +1,195 @@
+#include "TiledImage.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "MappedFile.hpp"
+#include "MatIO.hpp"
+
+namespace fs = std::filesystem;
+
+using std::size_t;
+
+namespace {
+
+const auto TILES_MAGIC = std::string("CTTILES");
+constexpr uint32_t TILES_VERSION = 1;
+constexpr size_t TILES_HEADER_SIZE = 64;
+
+/**
+ * @brief Returns the byte offset of a tile in a tiled image file.
+ */
+size_t tileOffset(const size_t tileIndex, const size_t tileSize) {
+    return TILES_HEADER_SIZE + tileIndex * tileSize * tileSize * sizeof(float);
+}
+
+/**
+ * @brief The layout of a tiled image file, as stored in its header.
+ */
+struct TilesHeader {
+    size_t width;
+    size_t height;
+    size_t tileSize;
+    size_t tilesX;
+};
+
+/**
+ * @brief Reads the header of a mapped tiled image file and checks that the file holds all tiles.
+ */
+TilesHeader readTilesHeader(const MappedFile& file) {
+    if (file.size() < TILES_HEADER_SIZE) throw std::runtime_error("Not a tiled image file.");
+
+    auto header = std::istringstream(
+        std::string(reinterpret_cast<const char*>(file.data()), TILES_HEADER_SIZE)
+    );
+    MatIO::readHeader(header, TILES_MAGIC, TILES_VERSION);
+    const auto width = MatIO::readValue<uint64_t>(header);
+    const auto height = MatIO::readValue<uint64_t>(header);
+    const auto tileSize = MatIO::readValue<uint64_t>(header);
+    if (tileSize == 0 || width > std::numeric_limits<int>::max() ||
+        height > std::numeric_limits<int>::max())
+        throw std::runtime_error("Corrupt tiled image file.");
+
+    // Divide instead of multiplying, so a corrupt header cannot overflow the size of the tiles
+    const auto tilesX = width / tileSize + (width % tileSize != 0);
+    const auto tilesY = height / tileSize + (height % tileSize != 0);
+    const auto numTiles = tilesX * tilesY;
+    const auto available = (file.size() - TILES_HEADER_SIZE) / sizeof(float);
+    if (numTiles > 0 &&
+        (tileSize > available / tileSize || numTiles > available / (tileSize * tileSize)))
+        throw std::runtime_error("Truncated tiled image file.");
+
+    return { width, height, tileSize, tilesX };
+}
+
+}  // namespace
+
+TiledImage::TiledImage(
+    const std::string& outputPath,
+    const std::size_t width,
+    const std::size_t height,
+    const std::size_t tileSize
+)
+    : m_outputPath(outputPath),
+      m_tmpPath(outputPath + ".tmp"),
+      m_file(m_tmpPath, std::ios::binary | std::ios::trunc),
+      m_width(width),
+      m_height(height),
+      m_tileSize(std::max(tileSize, size_t(1))) {
+    MatIO::writeHeader(m_file, TILES_MAGIC, TILES_VERSION);
+    MatIO::writeValue<uint64_t>(m_file, m_width);
+    MatIO::writeValue<uint64_t>(m_file, m_height);
+    MatIO::writeValue<uint64_t>(m_file, m_tileSize);
+
+    // Reserve the whole file, so tiles can be written in any order
+    const auto padding = TILES_HEADER_SIZE - static_cast<size_t>(m_file.tellp());
+    m_file.write(std::string(padding, '\0').data(), static_cast<std::streamsize>(padding));
+    const auto fileSize = tileOffset(getTilesX() * getTilesY(), m_tileSize);
+    m_file.seekp(static_cast<std::streamoff>(fileSize) - 1);
+    m_file.put('\0');
+
+    if (!m_file) {
+        spdlog::error("Failed to create tiled image '{}'.", m_tmpPath);
+        throw std::runtime_error("Failed to create tiled image.");
+    }
+
+    spdlog::info(
+        "Writing {}x{} image as {}x{} tiles of {} pixels to '{}'.",
+        m_width,
+        m_height,
+        getTilesX(),
+        getTilesY(),
+        m_tileSize,
+        m_outputPath
+    );
+}
+
+size_t TiledImage::getTilesX() const noexcept {
+    return (m_width + m_tileSize - 1) / m_tileSize;
+}
+
+size_t TiledImage::getTilesY() const noexcept {
+    return (m_height + m_tileSize - 1) / m_tileSize;
+}
+
+cv::Rect TiledImage::tileRegion(const std::size_t tileX, const std::size_t tileY) const {
+    const auto x = tileX * m_tileSize;
+    const auto y = tileY * m_tileSize;
+
+    return cv::Rect(x, y, std::min(m_tileSize, m_width - x), std::min(m_tileSize, m_height - y));
+}
+
+void TiledImage::writeTile(const std::size_t tileX, const std::size_t tileY, const cv::Mat& tile) {
+    if (tile.size() != tileRegion(tileX, tileY).size()) {
+        spdlog::error(
+            "Tile ({}, {}) has the wrong size {}x{}.", tileX, tileY, tile.cols, tile.rows
+        );
+        throw std::invalid_argument("Tile size does not match the tiled image.");
+    }
+
+    auto padded = cv::Mat(m_tileSize, m_tileSize, CV_32F, cv::Scalar(0));
+    tile.convertTo(padded(cv::Rect(0, 0, tile.cols, tile.rows)), CV_32F);
+
+    const auto offset = tileOffset(tileY * getTilesX() + tileX, m_tileSize);
+    m_file.seekp(static_cast<std::streamoff>(offset));
+    m_file.write(
+        reinterpret_cast<const char*>(padded.data),
+        static_cast<std::streamsize>(padded.total() * padded.elemSize())
+    );
+
+    if (!m_file) {
+        spdlog::error("Failed to write tile ({}, {}) to '{}'.", tileX, tileY, m_tmpPath);
+        throw std::runtime_error("Failed to write tile.");
+    }
+}
+
+void TiledImage::finish() {
+    m_file.close();
+    if (m_file.fail()) {
+        spdlog::error("Failed to write tiled image '{}'.", m_tmpPath);
+        throw std::runtime_error("Failed to write tiled image.");
+    }
+
+    fs::rename(m_tmpPath, m_outputPath);
+    spdlog::info("Saved tiled image as '{}'.", m_outputPath);
+}
+
+cv::Size TiledImage::readSize(const std::string& inputPath) {
+    const auto header = readTilesHeader(MappedFile(inputPath));
+    return cv::Size(header.width, header.height);
+}
+
+cv::Mat TiledImage::readRegion(const std::string& inputPath, const cv::Rect& region) {
+    const auto file = MappedFile(inputPath);
+    const auto [width, height, tileSize, tilesX] = readTilesHeader(file);
+
+    if ((region & cv::Rect(0, 0, width, height)) != region)
+        throw std::invalid_argument("Region exceeds the tiled image.");
+
+    auto result = cv::Mat(region.size(), CV_32F);
+    for (auto y = static_cast<size_t>(region.y); y < static_cast<size_t>(region.br().y); ++y) {
+        for (auto x = static_cast<size_t>(region.x); x < static_cast<size_t>(region.br().x);) {
+            // Copy the part of the row that lies in the current tile at once
+            const auto tileX = x / tileSize;
+            const auto tileY = y / tileSize;
+            const auto count = std::min((tileX + 1) * tileSize, size_t(region.br().x)) - x;
+
+            const auto* tile = file.data() + tileOffset(tileY * tilesX + tileX, tileSize);
+            const auto* source =
+                tile + ((y % tileSize) * tileSize + (x % tileSize)) * sizeof(float);
+            std::memcpy(
+                result.ptr<float>(y - region.y) + (x - region.x), source, count * sizeof(float)
+            );
+
+            x += count;
+        }
+    }
+
+    return result;
+}